@@ -291,13 +291,39 @@
  *      defined, NetHack can read an rlecomp or zerocomp savefile in, yet
  *      re-save without them.
  *
+ *      Defining COLCOMP builds in support for a column encoding of
+ *      level maps: each field of the map locations is stored as its own
+ *      run-length compressed plane, so that a change in one field doesn't
+ *      break the runs of the others.  If COLCOMP support is included it
+ *      takes precedence over RLECOMP and can be toggled on/off at runtime
+ *      via the config file option colcomp, which is off by default.  Files
+ *      written without it, including rlecomp ones, can still be read.
+ *      After external compression (gzip) the files come out larger than
+ *      rlecomp ones, so it is not recommended together with COMPRESS.
+ *
+ *      Defining LZCOMP builds in support for internal block compression
+ *      of everything, squeezing repeated byte strings as well as runs of
+ *      zeroes.  If LZCOMP support is included it is used in place of
+ *      COMPRESS or ZLIB_COMP, so no separate program is run; it can be
+ *      toggled on/off at runtime via the config file option lzcomp.
+ *
  *      Using any compression option will create smaller bones/level/save
  *      files at the cost of additional code and time.
+ *
+ *      Defining SAVECRC builds in support for checksums in bones, level,
+ *      and save files: what is written to them is split into chunks, each
+ *      carrying a CRC-32C which is checked as the chunk is read back in,
+ *      so a damaged file is noticed before any of the damage is used.  It
+ *      can be toggled on/off at runtime via the config file option savecrc.
+ *      Files written without it can still be read.
  */
 
 /* # define INTERNAL_COMP */ /* defines both ZEROCOMP and RLECOMP */
 /* # define ZEROCOMP      */ /* Support ZEROCOMP compression */
 /* # define RLECOMP       */ /* Support RLECOMP compression  */
+/* # define COLCOMP       */ /* Support COLCOMP compression  */
+/* # define LZCOMP        */ /* Support LZCOMP compression   */
+#define SAVECRC              /* Checksum save/level/bones files */
 
 /*
  *      Data librarian.  Defining DLB places most of the support files into
@@ -435,7 +461,20 @@ typedef unsigned char uchar;
  * functions that have been macroized.
  */
 
+/*
+ * VISION_BITBOARD selects a third algorithm that keeps the blocking map
+ * and the could-see marks as row bitmasks (COLNO bits per row) and checks
+ * a line of sight one row at a time with word-wide masks instead of one
+ * location at a time.  It sees the same things as the default algorithm,
+ * runs faster, and adds a 37K table.  It can't be combined with
+ * VISION_TABLES.
+ */
+
 /* #define VISION_TABLES */ /* use vision tables generated at compile time */
+/* #define VISION_BITBOARD */ /* use row bitmasks for line of sight */
+#if defined(VISION_TABLES) && defined(VISION_BITBOARD)
+#undef VISION_BITBOARD
+#endif
 #ifndef VISION_TABLES
 #ifndef NO_MACRO_CPATH
 #define MACRO_CPATH /* use clear_path macros instead of functions */
@@ -520,6 +559,12 @@ typedef unsigned char uchar;
    (within the same session) */
 /* #define EDIT_GETLIN */
 
+/* APPROACH_MAP makes monsters that are closing in on the hero follow a
+   shared map of walking distances from the hero instead of heading
+   straight for the hero's position, so that they find their way around
+   walls and boulders rather than bunching up behind them */
+/* #define APPROACH_MAP */
+
 /* #define DUMPLOG */  /* End-of-game dump logs */
 #ifdef DUMPLOG
 
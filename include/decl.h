@@ -393,6 +393,7 @@ struct opvar {
     union {
         char *str;
         long l;
+        unsigned long *sel; /* SPOVAR_SEL: one word per column */
     } vardata;
 };
 
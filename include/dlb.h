@@ -33,6 +33,12 @@ typedef struct dlb_library {
     long nentries; /* # of files in directory */
     long rev;      /* dlb file revision */
     long strsize;  /* dlb file string size */
+    long *hash;    /* directory indices + 1 by hash of name, 0 if unused */
+    long hashsize; /* # of hash slots, a power of 2 */
+#ifdef DLB_MMAP
+    char *fmap;    /* the whole library file, mapped into memory */
+    long fmapsize; /* its size */
+#endif
 } library;
 
 /* library definitions */
@@ -751,6 +751,13 @@ E int FDECL(create_levelfile, (int, char *));
 E int FDECL(open_levelfile, (int, char *));
 E void FDECL(delete_levelfile, (int));
 E void NDECL(clearlocks);
+E int FDECL(create_chkptfile, (char *));
+E void NDECL(chkpt_wait);
+#ifdef INSURANCE
+E int FDECL(create_scratchfile, (int));
+E void FDECL(chkpt_discard, (int));
+E boolean FDECL(chkpt_delta, (int, long));
+#endif
 E int FDECL(create_bonesfile, (d_level *, char **, char *));
 #ifdef MFLOPPY
 E void NDECL(cancel_bonesfile);
@@ -769,6 +776,7 @@ E void NDECL(set_error_savefile);
 E int NDECL(create_savefile);
 E int NDECL(open_savefile);
 E int NDECL(delete_savefile);
+E void FDECL(update_save_catalog, (BOOLEAN_P));
 E int NDECL(restore_saved_game);
 E void FDECL(nh_compress, (const char *));
 E void FDECL(nh_uncompress, (const char *));
@@ -792,6 +800,9 @@ E char *FDECL(plname_from_file, (const char *));
 #endif
 E char **NDECL(get_saved_games);
 E void FDECL(free_saved_games, (char **));
+#ifdef SELECTSAVED
+E char *FDECL(describe_saved_game, (const char *, char *));
+#endif
 #ifdef SELF_RECOVER
 E boolean NDECL(recover_savefile);
 #endif
@@ -799,6 +810,10 @@ E boolean NDECL(recover_savefile);
 E void NDECL(assure_syscf_file);
 #endif
 E int FDECL(nhclose, (int));
+E boolean FDECL(in_levelstore, (int));
+E int FDECL(nhwrite, (int, genericptr_t, unsigned));
+E int FDECL(nhread, (int, genericptr_t, unsigned));
+E long FDECL(nhseek, (int, long));
 #ifdef HOLD_LOCKFILE_OPEN
 E void NDECL(really_close);
 #endif
@@ -930,6 +945,11 @@ E void FDECL(strbuf_append, (strbuf_t *, const char *));
 E void FDECL(strbuf_reserve, (strbuf_t *, int));
 E void FDECL(strbuf_empty, (strbuf_t *));
 E void FDECL(strbuf_nl_to_crlf, (strbuf_t *));
+E void FDECL(idmap_add, (idmap_t *, unsigned, anything *));
+E boolean FDECL(idmap_remove, (idmap_t *, unsigned, anything *));
+E anything *FDECL(idmap_next, (idmap_t *, unsigned, int *));
+E void FDECL(idmap_empty, (idmap_t *));
+E unsigned long FDECL(crc32c, (unsigned long, genericptr_t, unsigned));
 
 /* ### invent.c ### */
 
@@ -1026,6 +1046,9 @@ E int NDECL(dosuspend);
 E void FDECL(new_light_source, (XCHAR_P, XCHAR_P, int, int, ANY_P *));
 E void FDECL(del_light_source, (int, ANY_P *));
 E void FDECL(do_light_sources, (char **));
+E void FDECL(light_block_changed, (int, int));
+E void NDECL(flush_light_cache);
+E boolean NDECL(light_sources_moved);
 E struct monst *FDECL(find_mid, (unsigned, unsigned));
 E void FDECL(save_light_sources, (int, int, int));
 E void FDECL(restore_light_sources, (int));
@@ -1124,6 +1147,7 @@ E void FDECL(readmail, (struct obj *));
 /* ### makemon.c ### */
 
 E void FDECL(dealloc_monst, (struct monst *));
+E void FDECL(index_mon_id, (struct monst *, int));
 E boolean FDECL(is_home_elemental, (struct permonst *));
 E struct monst *FDECL(clone_mon, (struct monst *, XCHAR_P, XCHAR_P));
 E int FDECL(monhp_per_lvl, (struct monst *));
@@ -1321,6 +1345,7 @@ E struct obj *FDECL(add_to_container, (struct obj *, struct obj *));
 E void FDECL(add_to_migration, (struct obj *));
 E void FDECL(add_to_buried, (struct obj *));
 E void FDECL(dealloc_obj, (struct obj *));
+E void FDECL(index_obj_id, (struct obj *));
 E void FDECL(obj_ice_effects, (int, int, BOOLEAN_P));
 E long FDECL(peek_at_iced_corpse_age, (struct obj *));
 E int FDECL(hornoplenty, (struct obj *, BOOLEAN_P));
@@ -1369,6 +1394,7 @@ E int FDECL(mfndpos, (struct monst *, coord *, long *, long));
 E boolean FDECL(monnear, (struct monst *, int, int));
 E void NDECL(dmonsfree);
 E int FDECL(mcalcmove, (struct monst *));
+E void NDECL(allot_mon_movement);
 E void NDECL(mcalcdistress);
 E void FDECL(replmon, (struct monst *, struct monst *));
 E void FDECL(relmon, (struct monst *, struct monst **));
@@ -1481,6 +1507,9 @@ E boolean FDECL(can_fog, (struct monst *));
 E boolean FDECL(should_displace,
                 (struct monst *, coord *, long *, int, XCHAR_P, XCHAR_P));
 E boolean FDECL(undesirable_disp, (struct monst *, XCHAR_P, XCHAR_P));
+#ifdef APPROACH_MAP
+E void NDECL(approach_map_stale);
+#endif
 
 /* ### monst.c ### */
 
@@ -1743,6 +1772,7 @@ E void NDECL(msgtype_free);
 
 /* ### pager.c ### */
 
+E void NDECL(free_datakeys);
 E char *FDECL(self_lookat, (char *));
 E void FDECL(mhidden_description, (struct monst *, BOOLEAN_P, char *));
 E boolean FDECL(object_from_map, (int,int,int,struct obj **));
@@ -2134,6 +2164,7 @@ E int NDECL(dosave0);
 E boolean FDECL(tricked_fileremoved, (int, char *));
 #ifdef INSURANCE
 E void NDECL(savestateinlock);
+E void NDECL(save_chkptdelta);
 #endif
 #ifdef MFLOPPY
 E boolean FDECL(savelev, (int, XCHAR_P, int));
@@ -2281,6 +2312,7 @@ E boolean
 FDECL(dig_corridor, (coord *, coord *, BOOLEAN_P, SCHAR_P, SCHAR_P));
 E void FDECL(fill_room, (struct mkroom *, BOOLEAN_P));
 E boolean FDECL(load_special, (const char *));
+E void NDECL(free_sp_lev_cache);
 E xchar FDECL(selection_getpoint, (int, int, struct opvar *));
 E struct opvar *FDECL(selection_opvar, (char *));
 E void FDECL(opvar_free_x, (struct opvar *));
@@ -2456,6 +2488,7 @@ E boolean FDECL(chest_trap, (struct obj *, int, BOOLEAN_P));
 E void FDECL(deltrap, (struct trap *));
 E boolean FDECL(delfloortrap, (struct trap *));
 E struct trap *FDECL(t_at, (int, int));
+E void FDECL(relocate_trap, (struct trap *, int, int));
 E void FDECL(b_trapped, (const char *, int));
 E boolean NDECL(unconscious);
 E void FDECL(blow_up_landmine, (struct trap *));
@@ -2611,6 +2644,7 @@ E boolean FDECL(clear_path, (int, int, int, int));
 E void FDECL(do_clear_area, (int, int, int,
                              void (*)(int, int, genericptr), genericptr_t));
 E unsigned FDECL(howmonseen, (struct monst *));
+E void NDECL(vision_bench);
 
 #ifdef VMS
 
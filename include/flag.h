@@ -295,8 +295,13 @@ struct instance_flags {
     long unhilite_deadline; /* time when oldest temp hilite should be unlit */
 #endif
     boolean zerocomp;         /* write zero-compressed save files */
+    boolean lzcomp;           /* write block-compressed save files */
     boolean rlecomp;          /* alternative to zerocomp; run-length encoding
                                * compression of levels when writing savefile */
+    boolean colcomp;          /* takes precedence over rlecomp; each field of
+                               * the levels' map compressed separately */
+    boolean savecrc;          /* checksum save, level, and bones files */
+    boolean uniform_text;     /* pick rumors &c by line, not by byte offset */
     uchar num_pad_mode;
 #if 0   /* XXXgraphics superseded by symbol sets */
     boolean  DECgraphics;       /* use DEC VT-xxx extended character set */
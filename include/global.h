@@ -290,12 +290,48 @@ struct savefile_info {
 #define SFI1_EXTERNALCOMP (1UL)
 #define SFI1_RLECOMP (1UL << 1)
 #define SFI1_ZEROCOMP (1UL << 2)
+#define SFI1_LZCOMP (1UL << 3)
+#define SFI1_COLCOMP (1UL << 4)
+#define SFI1_CRC32C (1UL << 5)
 #else
 #define SFI1_EXTERNALCOMP (1L)
 #define SFI1_RLECOMP (1L << 1)
 #define SFI1_ZEROCOMP (1L << 2)
+#define SFI1_LZCOMP (1L << 3)
+#define SFI1_COLCOMP (1L << 4)
+#define SFI1_CRC32C (1L << 5)
 #endif
 
+/*
+ * Checkpoint journal records, appended by the game and applied by
+ * recover.  Each record is followed by nparts parts, and each part by
+ * nhunks hunks, each hunk followed by the newcnt bytes which replace
+ * oldcnt bytes of the level file at off.  A record is only good if all
+ * size bytes of it made it into the journal.
+ */
+#define CHKPT_MAGIC 0x4e484a31L /* "NHJ1" */
+
+struct chkpt_record {
+    unsigned long magic; /* CHKPT_MAGIC */
+    unsigned long size;  /* bytes in the record, this header included */
+    long serial;         /* turn it was written on */
+    int pid;             /* of the game, as at the start of level 0 */
+    int nparts;          /* level files it changes */
+};
+
+struct chkpt_part {
+    int lev;              /* level file; 0 holds the game state */
+    int nhunks;
+    unsigned long oldlen; /* length of the level file before */
+    unsigned long newlen; /* and after */
+};
+
+struct chkpt_hunk {
+    unsigned long off;
+    unsigned long oldcnt;
+    unsigned long newcnt;
+};
+
 /*
  * Configurable internal parameters.
  *
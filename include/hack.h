@@ -169,6 +169,19 @@ typedef struct strbuf {
 #include "decl.h"
 #include "timeout.h"
 
+/* open-addressed map from object/monster ids to arbitrary values */
+struct idmap_ent {
+    unsigned id; /* 0 marks an unused slot */
+    anything val;
+};
+typedef struct idmap {
+    int cnt, siz; /* entries in use, slots allocated (a power of 2) */
+    struct idmap_ent *ent;
+} idmap_t;
+
+NEARDATA extern idmap_t obj_id_map; /* every allocated object, by o_id */
+NEARDATA extern idmap_t mon_id_map; /* every listed monster, by m_id */
+
 NEARDATA extern coord bhitpos; /* place where throw or zap hits or stops */
 
 /* types of calls to bhit() */
@@ -49,6 +49,7 @@ typedef struct ls_t {
     short flags;
     short type;  /* type of light source */
     anything id; /* source's identifier */
+    struct ls_lit *lit; /* cached lit area (light.c); not valid when restored */
 } light_source;
 
 #endif /* LEV_H */
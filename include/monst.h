@@ -112,10 +112,16 @@ struct monst {
 
     Bitfield(iswiz, 1);     /* is the Wizard of Yendor */
     Bitfield(wormno, 5);    /* at most 31 worms on any level */
-    /* 2 free bits */
+    Bitfield(mchain, 2);    /* which monster chain it's on, for find_mid() */
 
 #define MAX_NUM_WORMS 32    /* should be 2^(wormno bitfield size) */
 
+/* values for mchain */
+#define MCHAIN_NONE 0       /* in limbo */
+#define MCHAIN_FMON 1       /* fmon */
+#define MCHAIN_MIGRATE 2    /* migrating_mons */
+#define MCHAIN_MYDOGS 3     /* mydogs */
+
     unsigned long mstrategy; /* for monsters with mflag3: current strategy */
 #ifdef NHSTDC
 #define STRAT_APPEARMSG 0x80000000UL
@@ -421,6 +421,32 @@ struct rm {
     Bitfield(candig, 1); /* Exception to Can_dig_down; was a trapdoor */
 };
 
+/*
+ * The fields of struct rm, in the order that savelevl() writes them out
+ * as separate planes when the colcomp save option is in effect.  Each
+ * plane is a sequence of runs across the map, row by row: a run length
+ * (1..255) and then the run's value.  Values are single bytes, except in
+ * the LP_GLYPH plane, where they are a signed byte holding the change
+ * from the previous run's glyph or, if that won't fit, LP_ESC followed
+ * by the glyph in four bytes, low byte first.  A plane is preceded by
+ * the length of its encoding so that rest_levl() can read it in one go.
+ */
+enum levl_planes {
+    LP_TYP = 0,
+    LP_GLYPH,
+    LP_SEENV,
+    LP_FLAGS,
+    LP_HORIZONTAL,
+    LP_LIT,
+    LP_WASLIT,
+    LP_ROOMNO,
+    LP_EDGE,
+    LP_CANDIG,
+    NUM_LEVL_PLANES
+};
+#define LP_ESC 0x80
+#define LP_MAXLEN (ROWNO * COLNO * 6) /* worst case encoding of a plane */
+
 #define SET_TYPLIT(x, y, ttyp, llit)                              \
     {                                                             \
         if ((x) >= 0 && (y) >= 0 && (x) < COLNO && (y) < ROWNO) { \
@@ -592,6 +618,8 @@ typedef struct {
     struct monst *monsters[1][ROWNO];
     char *yuk2[COLNO - 1][ROWNO];
 #endif
+    struct trap *traps[COLNO][ROWNO];      /* first of ftrap at each spot */
+    struct engr *engravings[COLNO][ROWNO]; /* same for engravings */
     struct obj *objlist;
     struct obj *buriedobjlist;
     struct monst *monlist;
@@ -620,6 +648,9 @@ extern dlevel_t level; /* structure describing the current level */
 #define defsym_to_trap(d) ((d) -S_arrow_trap + 1)
 
 #define OBJ_AT(x, y) (level.objects[x][y] != (struct obj *) 0)
+/* bounds check for the level.traps[][] and level.engravings[][] lookups */
+#define level_index_ok(x, y) \
+    ((x) >= 0 && (x) < COLNO && (y) >= 0 && (y) < ROWNO)
 /*
  * Macros for encapsulation of level.monsters references.
  */
@@ -28,6 +28,8 @@ struct sysopt {
     int check_save_uid; /* restoring savefile checks UID? */
     int check_plname; /* use plname for checking wizards/explorers/shellers */
     int bones_pools;
+    int levelstore; /* kilobytes for keeping level files in memory */
+    int chkptdeltas; /* turns between checkpoint journal records */
 
     /* record file */
     int persmax;
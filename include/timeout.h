@@ -38,9 +38,11 @@ enum timeout_types {
 
 /* used in timeout.c */
 typedef struct fe {
-    struct fe *next;          /* next item in chain */
+    struct fe *next;          /* next item in same arg hash chain */
     long timeout;             /* when we time out */
     unsigned long tid;        /* timer ID */
+    unsigned long seq;        /* insertion order, for breaking ties */
+    int heapidx;              /* position in the timer queue */
     short kind;               /* kind of use */
     short func_index;         /* what to call when we time out */
     anything arg;             /* pointer to timeout argument */
@@ -227,6 +227,26 @@
  */
 #define ALTMETA /* support altmeta run-time option */
 
+/*
+ * With the checkpoint option on, level 0 is rewritten every time the hero
+ * changes levels.  Define THREADED_CHKPT to have that done by a separate
+ * thread so the game doesn't wait for it.  Needs POSIX threads; link with
+ * -pthread or -lpthread.
+ */
+/* #define THREADED_CHKPT */ /* write checkpoints in the background */
+
+/*
+ * Offer a menu of the player's saved games at startup (see the selectsaved
+ * option).  A catalog of the save directory, save/catalog, is kept so that
+ * the save files don't all have to be opened to build the menu.
+ */
+/* #define SELECTSAVED */ /* menu of saved games to choose from at start */
+
+#define MMAP_RESTORE /* read save, level, and bones files via mmap() */
+#ifdef DLB
+#define DLB_MMAP /* read the data library, nhdat, via mmap() */
+#endif
+
 #ifdef COMPRESS
 /* Some implementations of compress need a 'quiet' option.
  * If you've got one of these versions, put -q here.
@@ -108,12 +108,10 @@ boolean resuming;
                     /* both you and the monsters are out of steam this round
                      */
                     /* set up for a new turn */
-                    struct monst *mtmp;
                     mcalcdistress(); /* adjust monsters' trap, blind, etc */
 
                     /* reallocate movement rations to monsters */
-                    for (mtmp = fmon; mtmp; mtmp = mtmp->nmon)
-                        mtmp->movement += mcalcmove(mtmp);
+                    allot_mon_movement();
 
                     if (!rn2(u.uevent.udemigod
                                  ? 25
@@ -358,6 +356,9 @@ boolean resuming;
         }
 
         context.move = 1;
+#ifdef INSURANCE
+        save_chkptdelta();
+#endif
 
         if (multi >= 0 && occupation) {
 #if defined(MICRO) || defined(WIN32)
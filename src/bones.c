@@ -582,6 +582,7 @@ getbones()
         if (wizard) {
             if (yn("Get bones?") == 'n') {
                 (void) nhclose(fd);
+                reset_restpref();
                 compress_bonesfile();
                 return 0;
             }
@@ -636,6 +637,7 @@ getbones()
         }
     }
     (void) nhclose(fd);
+    reset_restpref(); /* validate() may have switched to the bones' own */
     sanitize_engravings();
     u.uroleplay.numbones++;
 
@@ -166,6 +166,7 @@ STATIC_DCL boolean FDECL(accept_menu_prefix, (int NDECL((*))));
 STATIC_DCL int NDECL(wiz_port_debug);
 #endif
 STATIC_PTR int NDECL(wiz_rumor_check);
+STATIC_PTR int NDECL(wiz_vision_bench);
 STATIC_PTR int NDECL(doattributes);
 
 STATIC_DCL void FDECL(enlght_line, (const char *, const char *, const char *,
@@ -1294,6 +1295,14 @@ wiz_rumor_check(VOID_ARGS)
     return 0;
 }
 
+/* #wizvisionbench command - time the vision algorithm on this level */
+STATIC_PTR int
+wiz_vision_bench(VOID_ARGS)
+{
+    vision_bench();
+    return 0;
+}
+
 /* #terrain command -- show known map, inspired by crawl's '|' command */
 STATIC_PTR int
 doterrain(VOID_ARGS)
@@ -3064,6 +3073,8 @@ struct ext_func_tab extcmdlist[] = {
             wiz_rumor_check, IFBURIED | AUTOCOMPLETE | WIZMODECMD },
     { '\0', "wizsmell", "smell monster",
             wiz_smell, IFBURIED | AUTOCOMPLETE | WIZMODECMD },
+    { '\0', "wizvisionbench", "time vision recalculation",
+            wiz_vision_bench, IFBURIED | AUTOCOMPLETE | WIZMODECMD },
     { '\0', "wizwhere", "show locations of special levels",
             wiz_where, IFBURIED | AUTOCOMPLETE | WIZMODECMD },
     { C('w'), "wizwish", "wish for something",
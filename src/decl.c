@@ -195,6 +195,11 @@ NEARDATA struct obj *migrating_objs = (struct obj *) 0;
 /* objects not yet paid for */
 NEARDATA struct obj *billobjs = (struct obj *) 0;
 
+/* every allocated object and every monster on one of the monster chains,
+   indexed by id for find_oid() and find_mid() */
+NEARDATA idmap_t obj_id_map = { 0, 0, 0 };
+NEARDATA idmap_t mon_id_map = { 0, 0, 0 };
+
 /* used to zero all elements of a struct obj and a struct monst */
 NEARDATA struct obj zeroobj = DUMMY;
 NEARDATA struct monst zeromonst = DUMMY;
@@ -297,6 +302,15 @@ NEARDATA struct savefile_info sfcap = {
 #endif
 #if defined(RLECOMP)
         | SFI1_RLECOMP
+#endif
+#if defined(COLCOMP)
+        | SFI1_COLCOMP
+#endif
+#if defined(SAVECRC)
+        | SFI1_CRC32C
+#endif
+#if defined(LZCOMP)
+        | SFI1_LZCOMP
 #endif
     ,
 #ifdef NHSTDC
@@ -320,6 +334,12 @@ NEARDATA struct savefile_info sfrestinfo, sfsaveinfo = {
 #endif
 #if defined(RLECOMP)
         | SFI1_RLECOMP
+#endif
+#if defined(COLCOMP)
+        | SFI1_COLCOMP
+#endif
+#if defined(SAVECRC)
+        | SFI1_CRC32C
 #endif
     ,
 #ifdef NHSTDC
@@ -8,6 +8,11 @@
 #ifdef __DJGPP__
 #include <string.h>
 #endif
+#ifdef DLB_MMAP
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
 
 #define DATAPREFIX 4
 
@@ -56,12 +61,20 @@ extern FILE *FDECL(fopen_datafile, (const char *, const char *, int));
  * only in the Amiga port (the second library holds the sound files).
  * For Unix, the idea would be to split the NetHack library
  * into text and binary parts, where the text version could be shared.
+ *
+ * Each library's directory is indexed by a hash of the file names, so
+ * an open doesn't have to compare the name against every entry.  With
+ * DLB_MMAP, the whole library is also mapped into memory when it's
+ * opened and reads are copied straight out of the mapping; processes
+ * running at the same time then share the same pages of it.
  */
 
 #define MAX_LIBS 4
 static library dlb_libs[MAX_LIBS];
 
 STATIC_DCL boolean FDECL(readlibdir, (library * lp));
+STATIC_DCL unsigned long FDECL(dlb_hash, (const char *));
+STATIC_DCL void FDECL(hashlibdir, (library * lp));
 STATIC_DCL boolean FDECL(find_file, (const char *name, library **lib,
                                      long *startp, long *sizep));
 STATIC_DCL boolean NDECL(lib_dlb_init);
@@ -161,6 +174,7 @@ library *lp; /* library pointer to fill in */
         else
             lp->dir[i].fsize = lp->dir[i + 1].foffset - lp->dir[i].foffset;
     }
+    hashlibdir(lp);
 
     (void) fseek(lp->fdata, 0L, SEEK_SET); /* reset back to zero */
     lp->fmark = 0;
@@ -168,6 +182,46 @@ library *lp; /* library pointer to fill in */
     return TRUE;
 }
 
+/* hash of a file name; case is ignored since FILENAME_CMP might */
+STATIC_OVL unsigned long
+dlb_hash(name)
+const char *name;
+{
+    unsigned long h = 2166136261UL;
+    int c;
+
+    while ((c = *name++) != '\0') {
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+        h = ((h ^ (unsigned long) c) * 16777619UL) & 0xffffffffUL;
+    }
+    return h;
+}
+
+/* index the directory by hash; where a name appears more than once, the
+   first entry is the one found, as when the directory was searched */
+STATIC_OVL void
+hashlibdir(lp)
+library *lp;
+{
+    long i, j, mask;
+
+    for (lp->hashsize = 16; lp->hashsize < 2 * lp->nentries;)
+        lp->hashsize *= 2;
+    lp->hash = (long *) alloc(lp->hashsize * sizeof(long));
+    (void) memset((genericptr_t) lp->hash, 0, lp->hashsize * sizeof(long));
+    mask = lp->hashsize - 1;
+    for (i = 0; i < lp->nentries; i++) {
+        for (j = (long) (dlb_hash(lp->dir[i].fname) & mask); lp->hash[j];
+             j = (j + 1) & mask)
+            if (!FILENAME_CMP(lp->dir[i].fname,
+                              lp->dir[lp->hash[j] - 1].fname))
+                break;
+        if (!lp->hash[j])
+            lp->hash[j] = i + 1;
+    }
+}
+
 /*
  * Look for the file in our directory structure.  Return 1 if successful,
  * 0 if not found.  Fill in the size and starting position.
@@ -178,16 +232,19 @@ const char *name;
 library **lib;
 long *startp, *sizep;
 {
-    int i, j;
+    int i;
+    long j, k, mask;
     library *lp;
 
     for (i = 0; i < MAX_LIBS && dlb_libs[i].fdata; i++) {
         lp = &dlb_libs[i];
-        for (j = 0; j < lp->nentries; j++) {
-            if (FILENAME_CMP(name, lp->dir[j].fname) == 0) {
+        mask = lp->hashsize - 1;
+        for (j = (long) (dlb_hash(name) & mask); (k = lp->hash[j]) != 0;
+             j = (j + 1) & mask) {
+            if (FILENAME_CMP(name, lp->dir[k - 1].fname) == 0) {
                 *lib = lp;
-                *startp = lp->dir[j].foffset;
-                *sizep = lp->dir[j].fsize;
+                *startp = lp->dir[k - 1].foffset;
+                *sizep = lp->dir[k - 1].fsize;
                 return TRUE;
             }
         }
@@ -211,6 +268,20 @@ library *lp;
     lp->fdata = fopen_datafile(lib_name, RDBMODE, DATAPREFIX);
     if (lp->fdata) {
         if (readlibdir(lp)) {
+#ifdef DLB_MMAP
+            struct stat st;
+
+            /* if it can't be mapped, it's read through stdio instead */
+            if (!fstat(fileno(lp->fdata), &st) && st.st_size > 0) {
+                lp->fmap = (char *) mmap((genericptr_t) 0,
+                                         (size_t) st.st_size, PROT_READ,
+                                         MAP_SHARED, fileno(lp->fdata), 0);
+                if (lp->fmap == (char *) MAP_FAILED)
+                    lp->fmap = (char *) 0;
+                else
+                    lp->fmapsize = (long) st.st_size;
+            }
+#endif
             status = TRUE;
         } else {
             (void) fclose(lp->fdata);
@@ -224,9 +295,14 @@ void
 close_library(lp)
 library *lp;
 {
+#ifdef DLB_MMAP
+    if (lp->fmap)
+        (void) munmap((genericptr_t) lp->fmap, (size_t) lp->fmapsize);
+#endif
     (void) fclose(lp->fdata);
     free((genericptr_t) lp->dir);
     free((genericptr_t) lp->sspace);
+    free((genericptr_t) lp->hash);
 
     (void) memset((char *) lp, 0, sizeof(library));
 }
@@ -309,6 +385,15 @@ dlb *dp;
         return 0;
 
     pos = dp->start + dp->mark;
+#ifdef DLB_MMAP
+    if (dp->lib->fmap && pos + size * quan <= dp->lib->fmapsize) {
+        nbytes = size * quan;
+        (void) memcpy((genericptr_t) buf,
+                      (genericptr_t) (dp->lib->fmap + pos), (size_t) nbytes);
+        dp->mark += nbytes;
+        return quan;
+    }
+#endif
     if (dp->lib->fmark != pos) {
         fseek(dp->lib->fdata, pos, SEEK_SET); /* check for error??? */
         dp->lib->fmark = pos;
@@ -367,6 +452,22 @@ dlb *dp;
         return (char *) 0;
 
     len--; /* save room for null */
+#ifdef DLB_MMAP
+    if (dp->lib->fmap && dp->start + dp->size <= dp->lib->fmapsize) {
+        const char *src = dp->lib->fmap + dp->start + dp->mark, *nl;
+        long n = dp->size - dp->mark;
+
+        /* up to and including the next newline, if it fits */
+        if (n > len)
+            n = len;
+        if ((nl = (const char *) memchr((genericptr_t) src, '\n',
+                                        (size_t) n)) != 0)
+            n = (long) (nl - src) + 1;
+        (void) memcpy((genericptr_t) buf, (genericptr_t) src, (size_t) n);
+        dp->mark += n;
+        bp = buf + n;
+    } else
+#endif
     for (i = 0, bp = buf; i < len && dp->mark < dp->size && c != '\n';
          i++, bp++) {
         if (dlb_fread(bp, 1, 1, dp) <= 0)
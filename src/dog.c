@@ -299,6 +299,7 @@ boolean with_you;
 
     mtmp->nmon = fmon;
     fmon = mtmp;
+    index_mon_id(mtmp, MCHAIN_FMON);
     if (mtmp->isshk)
         set_residency(mtmp, FALSE);
 
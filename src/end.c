@@ -1006,6 +1006,7 @@ void
 done(how)
 int how;
 {
+    chkpt_wait(); /* level 0 must be complete if the game is saved or ends */
     if (how == TRICKED) {
         if (killer.name[0]) {
             paniclog("trickery", killer.name);
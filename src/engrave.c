@@ -8,6 +8,8 @@
 
 STATIC_VAR NEARDATA struct engr *head_engr;
 
+STATIC_DCL void FDECL(reindex_engr_at, (int, int));
+
 char *
 random_engraving(outbuf)
 char *outbuf;
@@ -243,14 +245,9 @@ struct engr *
 engr_at(x, y)
 xchar x, y;
 {
-    register struct engr *ep = head_engr;
-
-    while (ep) {
-        if (x == ep->engr_x && y == ep->engr_y)
-            return ep;
-        ep = ep->nxt_engr;
-    }
-    return (struct engr *) 0;
+    if (!level_index_ok(x, y))
+        return (struct engr *) 0;
+    return level.engravings[x][y];
 }
 
 /* Decide whether a particular string is engraved at a specified
@@ -396,6 +393,7 @@ xchar e_type;
     head_engr = ep;
     ep->engr_x = x;
     ep->engr_y = y;
+    level.engravings[x][y] = ep;
     ep->engr_txt = (char *) (ep + 1);
     Strcpy(ep->engr_txt, s);
     /* engraving Elbereth shows wisdom */
@@ -1172,8 +1170,10 @@ int fd, mode;
             bwrite(fd, (genericptr_t) &ep->engr_lth, sizeof ep->engr_lth);
             bwrite(fd, (genericptr_t) ep, sizeof (struct engr) + ep->engr_lth);
         }
-        if (release_data(mode))
+        if (release_data(mode)) {
+            level.engravings[ep->engr_x][ep->engr_y] = (struct engr *) 0;
             dealloc_engr(ep);
+        }
     }
     if (perform_bwrite(mode))
         bwrite(fd, (genericptr_t) &no_more_engr, sizeof no_more_engr);
@@ -1187,8 +1187,12 @@ int fd;
 {
     struct engr *ep;
     unsigned lth;
+    int x, y;
 
     head_engr = 0;
+    for (x = 0; x < COLNO; x++)
+        for (y = 0; y < ROWNO; y++)
+            level.engravings[x][y] = (struct engr *) 0;
     while (1) {
         mread(fd, (genericptr_t) &lth, sizeof lth);
         if (lth == 0)
@@ -1197,6 +1201,7 @@ int fd;
         mread(fd, (genericptr_t) ep, sizeof (struct engr) + lth);
         ep->nxt_engr = head_engr;
         head_engr = ep;
+        level.engravings[ep->engr_x][ep->engr_y] = ep;
         ep->engr_txt = (char *) (ep + 1); /* Andreas Bormann */
         /* Mark as finished for bones levels -- no problem for
          * normal levels as the player must have finished engraving
@@ -1242,15 +1247,30 @@ register struct engr *ep;
             return;
         }
     }
+    if (level.engravings[ep->engr_x][ep->engr_y] == ep)
+        reindex_engr_at(ep->engr_x, ep->engr_y);
     dealloc_engr(ep);
 }
 
+/* level.engravings[x][y] is the first engraving on head_engr at <x,y> */
+STATIC_OVL void
+reindex_engr_at(x, y)
+int x, y;
+{
+    register struct engr *ep;
+
+    for (ep = head_engr; ep; ep = ep->nxt_engr)
+        if (ep->engr_x == x && ep->engr_y == y)
+            break;
+    level.engravings[x][y] = ep;
+}
+
 /* randomly relocate an engraving */
 void
 rloc_engr(ep)
 struct engr *ep;
 {
-    int tx, ty, tryct = 200;
+    int tx, ty, ox, oy, tryct = 200;
 
     do {
         if (--tryct < 0)
@@ -1259,8 +1279,12 @@ struct engr *ep;
         ty = rn2(ROWNO);
     } while (engr_at(tx, ty) || !goodpos(tx, ty, (struct monst *) 0, 0));
 
+    ox = ep->engr_x, oy = ep->engr_y;
     ep->engr_x = tx;
     ep->engr_y = ty;
+    if (level.engravings[ox][oy] == ep)
+        reindex_engr_at(ox, oy);
+    level.engravings[tx][ty] = ep;
 }
 
 /* Create a headstone at the given location.
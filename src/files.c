@@ -41,8 +41,9 @@ const
 #endif
 #endif
 
-#if defined(UNIX) && defined(QT_GRAPHICS)
+#if defined(UNIX) && (defined(QT_GRAPHICS) || defined(SELECTSAVED))
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <dirent.h>
 #include <stdlib.h>
 #endif
@@ -51,6 +52,16 @@ const
 #include <signal.h>
 #endif
 
+#ifdef THREADED_CHKPT
+#include <pthread.h>
+#endif
+
+#ifdef MMAP_RESTORE
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
 #if defined(MSDOS) || defined(OS2) || defined(TOS) || defined(WIN32)
 #ifndef GNUDOS
 #include <sys\stat.h>
@@ -125,6 +136,105 @@ struct level_ftrack {
 #endif
 #endif /*HOLD_LOCKFILE_OPEN*/
 
+/*
+ * Level store:  if sysconf's LEVELSTORE gives it a budget, the files for
+ * levels the hero has left are kept in memory instead of on disk.  They
+ * are reached through pseudo file descriptors which nhwrite(), nhread(),
+ * and nhclose() know about, so savelev() and getlev() don't care where
+ * a level is kept.  When the store grows past its budget, the levels
+ * used least recently are moved out to ordinary level files.  Level 0,
+ * which recover needs, always goes to disk; its slot is only used by
+ * the checkpoint writer below.  Two more slots past the last level are
+ * scratch space for the checkpoint journal.
+ */
+#define LEVSTORE_FD0 0x40000000 /* pseudo fd for level N is LEVSTORE_FD0+N */
+#define LEVSTORE_CHUNK 16384    /* minimum allocation for a level */
+#define LEVSTORE_SCRATCH MAXLINFO /* first of the journal's scratch slots */
+
+static struct levstore {
+    char *buf;          /* level file contents, or null */
+    unsigned long len;  /* bytes used in buf */
+    unsigned long size; /* bytes allocated for buf */
+    unsigned long pos;  /* where the next read starts */
+    long lastuse;       /* levstore_clock when last opened */
+    int mode;           /* LS_CLOSED, LS_WRITE, or LS_READ */
+} levstore[MAXLINFO + 2];
+#define LS_CLOSED 0
+#define LS_WRITE 1
+#define LS_READ 2
+
+static unsigned long levstore_total = 0L; /* bytes held in the store */
+static long levstore_clock = 0L;
+static boolean levstore_spilling = FALSE; /* creating a real level file */
+
+#ifdef THREADED_CHKPT
+/*
+ * Checkpoint writer:  with the checkpoint option on, savestateinlock()
+ * rewrites level 0 every time the hero changes levels.  It serializes
+ * into the level store's slot 0, and closing that starts a thread which
+ * writes the data to a scratch file and renames it over level 0, so the
+ * previous checkpoint stays intact until the new one is complete.  Only
+ * one checkpoint is written at a time.  chkpt_wait() waits for it, and
+ * anything that uses level 0 calls it first.  The thread mustn't touch
+ * anything but chkpt_job.
+ */
+static struct chkpt_job {
+    char name[BUFSZ];              /* level 0 file, for messages */
+    char path[FQN_MAX_FILENAME];   /* level 0 file, fully qualified */
+    char tmppath[FQN_MAX_FILENAME + 4]; /* where it's written first */
+    char *buf;                     /* the checkpoint */
+    unsigned long len;
+    int err; /* errno if writing failed, otherwise 0 */
+} chkpt_job;
+static pthread_t chkpt_thread;
+static boolean chkpt_busy = FALSE; /* chkpt_thread is running */
+#endif
+
+#ifdef INSURANCE
+/*
+ * Checkpoint journal:  with the checkpoint option on, level 0 and the
+ * current level are normally only written when the hero changes levels.
+ * If sysconf's CHECKPOINT_DELTAS asks for it, save_chkptdelta() also
+ * serializes both into the level store's scratch slots every so many
+ * turns, and chkpt_delta() compares them with images of what the level
+ * files hold once the journal is applied.  Only the byte ranges which
+ * differ are appended to the journal, one record per checkpoint, and
+ * recover applies them before it puts the save file together.  Writing
+ * or deleting either file makes the journal obsolete, so it is removed
+ * first.
+ */
+#define CHKPT_GAP 16   /* differing ranges closer than this are merged */
+#define CHKPT_BLOCK 64 /* bytes compared at a time while they match */
+
+static struct chkpt_image {
+    int lev;            /* level file this is an image of, or -1 */
+    char *buf;
+    unsigned long len;  /* bytes used in buf */
+    unsigned long size; /* bytes allocated for buf */
+} chkpt_images[2] = { { -1, (char *) 0, 0L, 0L }, { -1, (char *) 0, 0L, 0L } };
+static unsigned long chkpt_jlen = 0L; /* bytes in the journal */
+static char *chkpt_rec = (char *) 0;  /* record being put together */
+static unsigned long chkpt_reclen = 0L, chkpt_recsize = 0L;
+#endif
+
+#ifdef MMAP_RESTORE
+/*
+ * Save, level, and bones files opened for reading are mapped into memory
+ * and nhread() copies from the mapping, rather than making a read() call
+ * for every field of every object and monster.  Anything reading such a
+ * file has to use nhread() and nhseek() instead of read() and lseek().
+ * A file that can't be mapped is read the ordinary way.
+ */
+#define NHMAPS 4 /* files mapped at the same time */
+
+static struct nhmap {
+    int fd;
+    char *base;        /* start of mapping, or null if slot is free */
+    unsigned long len; /* file size */
+    unsigned long pos; /* where the next read starts */
+} nhmap[NHMAPS];
+#endif
+
 #define WIZKIT_MAX 128
 static char wizkit[WIZKIT_MAX];
 STATIC_DCL FILE *NDECL(fopen_wizkit_file);
@@ -173,9 +283,52 @@ extern int n_dgns; /* from dungeon.c */
 #define SELECTSAVED
 #endif
 
+#if defined(UNIX) && defined(SELECTSAVED)
+/*
+ * Saved game catalog:  a file in the save directory with a line for each
+ * save file, so that the menu of saved games doesn't have to open (and
+ * maybe uncompress) every one of them to find out whose it is.  dosave0()
+ * and delete_savefile() keep it current.  Each entry records the save
+ * file's size and modification time, and get_saved_games() reads the
+ * header of any save file whose entry is missing or out of date, drops
+ * entries for files that are gone, and writes the catalog back out.  It
+ * is always rewritten to a scratch file which is then renamed, so it's
+ * never seen half written.  Two games updating it at the same moment
+ * can lose one of the changes; the next get_saved_games() repairs that.
+ */
+#define SAVE_CATALOG "save/catalog"
+#define SAVECAT_MAGIC "NetHack saved games 1"
+
+static struct savecat {
+    char *file;        /* save file, within the save directory */
+    char *name;        /* character name */
+    long mtime, size;  /* of the file when the entry was made */
+    char role[4];      /* role's file code, or "" if not known */
+    int depth;         /* dungeon depth, or 0 if not known */
+    long turn;         /* game turn, or 0 if not known */
+    char when[15];     /* when it was saved, as yyyymmddhhmmss */
+    boolean seen;      /* get_saved_games() came across the file */
+} *savecat = 0;
+static int savecat_n = 0, savecat_size = 0;
+static int savecat_sorted = 0; /* savecat[0..savecat_sorted-1] are sorted */
+static boolean savecat_changed = FALSE;
+#endif
+
 #ifdef SELECTSAVED
 STATIC_PTR int FDECL(CFDECLSPEC strcmp_wrap, (const void *, const void *));
 #endif
+#ifdef SAVE_CATALOG
+STATIC_PTR int FDECL(CFDECLSPEC savecat_cmp, (const void *, const void *));
+STATIC_DCL void NDECL(savecat_load);
+STATIC_DCL void NDECL(savecat_store);
+STATIC_DCL void NDECL(savecat_free);
+STATIC_DCL struct savecat *NDECL(savecat_new);
+STATIC_DCL struct savecat *FDECL(savecat_find, (const char *));
+STATIC_DCL struct savecat *FDECL(savecat_enter, (const char *, const char *,
+                                                 struct stat *));
+STATIC_DCL void FDECL(savecat_remove, (const char *));
+STATIC_DCL char *FDECL(savecat_plname, (const char *, struct savecat *));
+#endif
 STATIC_DCL char *FDECL(set_bonesfile_name, (char *, d_level *));
 STATIC_DCL char *NDECL(set_bonestemp_name);
 #ifdef COMPRESS
@@ -211,10 +364,40 @@ STATIC_DCL boolean FDECL(is_config_section, (const char *));
 STATIC_DCL boolean FDECL(handle_config_section, (char *));
 #ifdef SELF_RECOVER
 STATIC_DCL boolean FDECL(copy_bytes, (int, int));
+STATIC_DCL boolean FDECL(write_levc, (int, XCHAR_P,
+                                      struct savefile_info *));
+#ifdef INSURANCE
+STATIC_DCL unsigned long FDECL(chkpt_apply, (char *, char *, int));
+STATIC_DCL void NDECL(chkpt_replay);
+#endif
 #endif
 #ifdef HOLD_LOCKFILE_OPEN
 STATIC_DCL int FDECL(open_levelfile_exclusively, (const char *, int, int));
 #endif
+STATIC_DCL int FDECL(levstore_write, (int, genericptr_t, unsigned));
+STATIC_DCL int FDECL(levstore_close, (int));
+STATIC_DCL boolean FDECL(levstore_spill, (int));
+STATIC_DCL void FDECL(levstore_trim, (unsigned long));
+#ifdef INSURANCE
+STATIC_DCL char *FDECL(chkpt_journal_name, (char *));
+STATIC_DCL void FDECL(chkpt_forget, (struct chkpt_image *));
+STATIC_DCL boolean FDECL(chkpt_load, (struct chkpt_image *, int));
+STATIC_DCL boolean FDECL(chkpt_slurp, (struct chkpt_image *, int));
+STATIC_DCL void FDECL(chkpt_put, (genericptr_t, unsigned long));
+STATIC_DCL void FDECL(chkpt_hunk, (unsigned long, unsigned long,
+                                   unsigned long, const char *));
+STATIC_DCL int FDECL(chkpt_diff, (struct chkpt_image *, struct levstore *));
+#endif
+#ifdef MMAP_RESTORE
+STATIC_DCL void FDECL(nhmap_open, (int));
+STATIC_DCL struct nhmap *FDECL(nhmap_find, (int));
+STATIC_DCL void FDECL(nhmap_close, (int));
+#endif
+#ifdef THREADED_CHKPT
+STATIC_DCL int NDECL(chkpt_start);
+STATIC_DCL genericptr_t FDECL(chkpt_writer, (genericptr_t));
+STATIC_DCL int NDECL(chkpt_report);
+#endif
 
 
 static char *config_section_chosen = (char *) 0;
@@ -494,9 +677,33 @@ char errbuf[];
 
     if (errbuf)
         *errbuf = '\0';
+    if (lev == 0)
+        chkpt_wait();
+#ifdef INSURANCE
+    chkpt_discard(lev);
+#endif
     set_levelfile_name(lock, lev);
     fq_lock = fqname(lock, LEVELPREFIX, 0);
 
+    if (lev > 0 && lev < MAXLINFO && sysopt.levelstore > 0
+        && !levstore_spilling) {
+        struct levstore *ls = &levstore[lev];
+
+        if (ls->mode != LS_CLOSED)
+            impossible("create_levelfile: level %d is already open", lev);
+        /* replace whatever was saved of this level before */
+        if (ls->buf) {
+            levstore_total -= ls->len;
+        } else if (level_info[lev].flags & LFILE_EXISTS) {
+            (void) unlink(fq_lock);
+        }
+        ls->len = ls->pos = 0L;
+        ls->lastuse = ++levstore_clock;
+        ls->mode = LS_WRITE;
+        level_info[lev].flags |= LFILE_EXISTS;
+        return LEVSTORE_FD0 + lev;
+    }
+
 #if defined(MICRO) || defined(WIN32)
 /* Use O_TRUNC to force the file to be shortened if it already
  * exists and is currently longer.
@@ -535,6 +742,18 @@ char errbuf[];
 
     if (errbuf)
         *errbuf = '\0';
+    if (lev == 0)
+        chkpt_wait();
+    if (lev > 0 && lev < MAXLINFO && levstore[lev].buf) {
+        struct levstore *ls = &levstore[lev];
+
+        if (ls->mode != LS_CLOSED)
+            impossible("open_levelfile: level %d is already open", lev);
+        ls->pos = 0L;
+        ls->lastuse = ++levstore_clock;
+        ls->mode = LS_READ;
+        return LEVSTORE_FD0 + lev;
+    }
     set_levelfile_name(lock, lev);
     fq_lock = fqname(lock, LEVELPREFIX, 0);
 #ifdef MFLOPPY
@@ -559,6 +778,10 @@ char errbuf[];
     if (fd < 0 && errbuf)
         Sprintf(errbuf, "Cannot open file \"%s\" for level %d (errno %d).",
                 lock, lev, errno);
+#ifdef MMAP_RESTORE
+    if (fd >= 0)
+        nhmap_open(fd);
+#endif
 
     return fd;
 }
@@ -571,6 +794,20 @@ int lev;
      * Level 0 might be created by port specific code that doesn't
      * call create_levfile(), so always assume that it exists.
      */
+    if (lev == 0)
+        chkpt_wait();
+#ifdef INSURANCE
+    chkpt_discard(lev);
+#endif
+    if (lev > 0 && lev < MAXLINFO && levstore[lev].buf) {
+        struct levstore *ls = &levstore[lev];
+
+        levstore_total -= ls->len;
+        free((genericptr_t) ls->buf);
+        ls->buf = (char *) 0;
+        ls->len = ls->size = ls->pos = 0L;
+        ls->mode = LS_CLOSED;
+    }
     if (lev == 0 || (level_info[lev].flags & LFILE_EXISTS)) {
         set_levelfile_name(lock, lev);
 #ifdef HOLD_LOCKFILE_OPEN
@@ -586,8 +823,11 @@ void
 clearlocks()
 {
 #ifdef HANGUPHANDLING
-    if (program_state.preserve_locks)
+    if (program_state.preserve_locks) {
+        chkpt_wait();
+        levstore_trim(0L); /* recover will need everything on disk */
         return;
+    }
 #endif
 #if !defined(PC_LOCKING) && defined(MFLOPPY) && !defined(AMIGA)
     eraseall(levels, alllevels);
@@ -683,6 +923,11 @@ int
 nhclose(fd)
 int fd;
 {
+    if (in_levelstore(fd))
+        return levstore_close(fd);
+#ifdef MMAP_RESTORE
+    nhmap_close(fd);
+#endif
     if (lftrack.fd == fd) {
         really_close(); /* close it, but reopen it to hold it */
         fd = open_levelfile(0, (char *) 0);
@@ -697,10 +942,657 @@ int
 nhclose(fd)
 int fd;
 {
+    if (in_levelstore(fd))
+        return levstore_close(fd);
+#ifdef MMAP_RESTORE
+    nhmap_close(fd);
+#endif
     return close(fd);
 }
 #endif /* ?HOLD_LOCKFILE_OPEN */
 
+/* is fd one of the level store's pseudo file descriptors? */
+boolean
+in_levelstore(fd)
+int fd;
+{
+    return (boolean) (fd >= LEVSTORE_FD0 && fd < LEVSTORE_FD0 + MAXLINFO + 2);
+}
+
+/* write() that knows about the level store */
+int
+nhwrite(fd, buf, len)
+int fd;
+genericptr_t buf;
+unsigned len;
+{
+    if (in_levelstore(fd))
+        return levstore_write(fd - LEVSTORE_FD0, buf, len);
+    /* lint wants 3rd arg of write to be an int; lint -p an unsigned */
+#if defined(BSD) || defined(ULTRIX) || defined(WIN32) || defined(_MSC_VER)
+    return (int) write(fd, buf, (int) len);
+#else /* e.g. SYSV, __TURBOC__ */
+    return (int) write(fd, buf, len);
+#endif
+}
+
+/* read() that knows about the level store and mapped files */
+int
+nhread(fd, buf, len)
+int fd;
+genericptr_t buf;
+unsigned len;
+{
+    struct levstore *ls;
+
+    if (!in_levelstore(fd)) {
+#ifdef MMAP_RESTORE
+        struct nhmap *m = nhmap_find(fd);
+
+        if (m) {
+            if (len > m->len - m->pos)
+                len = (unsigned) (m->len - m->pos);
+            (void) memcpy(buf, (genericptr_t) &m->base[m->pos], len);
+            m->pos += len;
+            return (int) len;
+        }
+#endif
+        return (int) read(fd, buf, len);
+    }
+    ls = &levstore[fd - LEVSTORE_FD0];
+    if (ls->mode != LS_READ)
+        return -1;
+    if (len > ls->len - ls->pos)
+        len = (unsigned) (ls->len - ls->pos);
+    (void) memcpy(buf, (genericptr_t) &ls->buf[ls->pos], len);
+    ls->pos += len;
+    return (int) len;
+}
+
+/* lseek() to offset from the start, for files read with nhread() */
+long
+nhseek(fd, offset)
+int fd;
+long offset;
+{
+    if (in_levelstore(fd)) {
+        struct levstore *ls = &levstore[fd - LEVSTORE_FD0];
+
+        ls->pos = (unsigned long) min(max(offset, 0L), (long) ls->len);
+        return (long) ls->pos;
+    }
+#ifdef MMAP_RESTORE
+    {
+        struct nhmap *m = nhmap_find(fd);
+
+        if (m) {
+            m->pos = (unsigned long) min(max(offset, 0L), (long) m->len);
+            return (long) m->pos;
+        }
+    }
+#endif
+    return (long) lseek(fd, (off_t) offset, 0);
+}
+
+#ifdef MMAP_RESTORE
+/* map a file that has just been opened for reading */
+STATIC_OVL void
+nhmap_open(fd)
+int fd;
+{
+    struct stat st;
+    genericptr_t p;
+    int i;
+
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+        return;
+    for (i = 0; i < NHMAPS; i++)
+        if (!nhmap[i].base)
+            break;
+    if (i == NHMAPS)
+        return; /* read this one the ordinary way */
+    p = mmap((genericptr_t) 0, (size_t) st.st_size, PROT_READ, MAP_PRIVATE,
+             fd, (off_t) 0);
+    if (p == MAP_FAILED)
+        return;
+    nhmap[i].fd = fd;
+    nhmap[i].base = (char *) p;
+    nhmap[i].len = (unsigned long) st.st_size;
+    nhmap[i].pos = 0L;
+}
+
+STATIC_OVL struct nhmap *
+nhmap_find(fd)
+int fd;
+{
+    int i;
+
+    for (i = 0; i < NHMAPS; i++)
+        if (nhmap[i].base && nhmap[i].fd == fd)
+            return &nhmap[i];
+    return (struct nhmap *) 0;
+}
+
+STATIC_OVL void
+nhmap_close(fd)
+int fd;
+{
+    struct nhmap *m = nhmap_find(fd);
+
+    if (m) {
+        (void) munmap((genericptr_t) m->base, (size_t) m->len);
+        m->base = (char *) 0;
+    }
+}
+#endif /* MMAP_RESTORE */
+
+STATIC_OVL int
+levstore_write(lev, buf, len)
+int lev;
+genericptr_t buf;
+unsigned len;
+{
+    struct levstore *ls = &levstore[lev];
+
+    if (ls->mode != LS_WRITE)
+        return -1;
+    if (ls->len + len > ls->size) {
+        unsigned long newsize = max(ls->size * 2L, LEVSTORE_CHUNK);
+        char *newbuf;
+
+        while (newsize < ls->len + len)
+            newsize *= 2L;
+        newbuf = (char *) alloc(newsize);
+        if (ls->buf) {
+            (void) memcpy((genericptr_t) newbuf, (genericptr_t) ls->buf,
+                          ls->len);
+            free((genericptr_t) ls->buf);
+        }
+        ls->buf = newbuf;
+        ls->size = newsize;
+    }
+    (void) memcpy((genericptr_t) &ls->buf[ls->len], buf, len);
+    ls->len += len;
+    levstore_total += len;
+    return (int) len;
+}
+
+STATIC_OVL int
+levstore_close(fd)
+int fd;
+{
+    int lev = fd - LEVSTORE_FD0;
+    struct levstore *ls = &levstore[lev];
+
+    if (ls->mode == LS_WRITE) {
+        ls->mode = LS_CLOSED;
+        if (lev >= LEVSTORE_SCRATCH) {
+            /* scratch slots belong to chkpt_delta() */
+            levstore_total -= ls->len;
+            return 0;
+        }
+#ifdef THREADED_CHKPT
+        if (!lev) {
+            /* slot 0 keeps its buffer for the next checkpoint */
+            levstore_total -= ls->len;
+            return chkpt_start();
+        }
+#endif
+        levstore_trim((unsigned long) sysopt.levelstore * 1024L);
+    } else if (ls->mode == LS_READ) {
+        /* the level is in play again; it'll be saved anew when the
+           hero leaves, so this copy won't be wanted any more */
+        levstore_total -= ls->len;
+        free((genericptr_t) ls->buf);
+        ls->buf = (char *) 0;
+        ls->len = ls->size = ls->pos = 0L;
+        ls->mode = LS_CLOSED;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/* move a level out of the store to an ordinary level file */
+STATIC_OVL boolean
+levstore_spill(lev)
+int lev;
+{
+    struct levstore *ls = &levstore[lev];
+    int fd;
+    boolean ok;
+
+    levstore_spilling = TRUE;
+    fd = create_levelfile(lev, (char *) 0);
+    levstore_spilling = FALSE;
+    if (fd < 0)
+        return FALSE;
+    ok = (nhwrite(fd, (genericptr_t) ls->buf, (unsigned) ls->len)
+          == (int) ls->len);
+    if (close(fd) < 0)
+        ok = FALSE;
+    if (!ok) {
+        /* keep the copy in memory; the partial file is no good */
+        set_levelfile_name(lock, lev);
+        (void) unlink(fqname(lock, LEVELPREFIX, 0));
+        return FALSE;
+    }
+    levstore_total -= ls->len;
+    free((genericptr_t) ls->buf);
+    ls->buf = (char *) 0;
+    ls->len = ls->size = ls->pos = 0L;
+    return TRUE;
+}
+
+/* spill least recently used levels until the store is within budget */
+STATIC_OVL void
+levstore_trim(budget)
+unsigned long budget;
+{
+    int lev, oldest;
+
+    while (levstore_total > budget) {
+        oldest = 0;
+        for (lev = 1; lev < MAXLINFO; lev++)
+            if (levstore[lev].buf && levstore[lev].mode == LS_CLOSED
+                && (!oldest
+                    || levstore[lev].lastuse < levstore[oldest].lastuse))
+                oldest = lev;
+        if (!oldest || !levstore_spill(oldest))
+            break;
+    }
+}
+
+/* create level 0 for a checkpoint; it's written out when it's closed */
+int
+create_chkptfile(errbuf)
+char errbuf[];
+{
+#ifdef THREADED_CHKPT
+    struct levstore *ls = &levstore[0];
+
+    if (errbuf)
+        *errbuf = '\0';
+    chkpt_wait();
+#ifdef INSURANCE
+    chkpt_discard(0);
+#endif
+    if (ls->mode != LS_CLOSED)
+        impossible("create_chkptfile: checkpoint is already open");
+    ls->len = ls->pos = 0L;
+    ls->mode = LS_WRITE;
+    return LEVSTORE_FD0;
+#else
+    return create_levelfile(0, errbuf);
+#endif
+}
+
+/* wait until the checkpoint being written, if any, is finished */
+void
+chkpt_wait()
+{
+#ifdef THREADED_CHKPT
+    if (chkpt_busy) {
+        (void) pthread_join(chkpt_thread, (genericptr_t *) 0);
+        chkpt_busy = FALSE;
+        (void) chkpt_report();
+    }
+#endif
+}
+
+#ifdef THREADED_CHKPT
+/* hand the checkpoint in level store slot 0 to the writer thread */
+STATIC_OVL int
+chkpt_start()
+{
+    struct levstore *ls = &levstore[0];
+
+    set_levelfile_name(lock, 0);
+    Strcpy(chkpt_job.name, lock);
+    Strcpy(chkpt_job.path, fqname(lock, LEVELPREFIX, 0));
+    Sprintf(chkpt_job.tmppath, "%s.new", chkpt_job.path);
+    chkpt_job.buf = ls->buf;
+    chkpt_job.len = ls->len;
+    chkpt_job.err = 0;
+    if (!pthread_create(&chkpt_thread, (pthread_attr_t *) 0, chkpt_writer,
+                        (genericptr_t) &chkpt_job)) {
+        chkpt_busy = TRUE;
+        return 0;
+    }
+    /* no thread to be had; write it ourselves */
+    (void) chkpt_writer((genericptr_t) &chkpt_job);
+    return chkpt_report();
+}
+
+/* the writer thread */
+STATIC_OVL genericptr_t
+chkpt_writer(arg)
+genericptr_t arg;
+{
+    struct chkpt_job *job = (struct chkpt_job *) arg;
+    unsigned long off;
+    int fd, n;
+
+    if ((fd = creat(job->tmppath, FCMASK)) < 0) {
+        job->err = errno;
+        return arg;
+    }
+    for (off = 0L; off < job->len; off += (unsigned long) n) {
+        n = (int) write(fd, (genericptr_t) &job->buf[off],
+                        (unsigned) min(job->len - off, 32768L));
+        if (n <= 0) {
+            job->err = (n < 0) ? errno : ENOSPC;
+            break;
+        }
+    }
+    /* make sure the data is on disk before the rename can be; otherwise
+       a crash could leave recover an empty level 0 in place of the old */
+    if (!job->err && fsync(fd) < 0)
+        job->err = errno;
+    if (close(fd) < 0 && !job->err)
+        job->err = errno;
+    if (!job->err && rename(job->tmppath, job->path) < 0)
+        job->err = errno;
+    if (job->err)
+        (void) unlink(job->tmppath);
+    return arg;
+}
+
+/* complain if the last checkpoint couldn't be written */
+STATIC_OVL int
+chkpt_report()
+{
+    if (!chkpt_job.err)
+        return 0;
+    pline("Cannot write checkpoint file \"%s\" (errno %d).",
+          chkpt_job.name, chkpt_job.err);
+    chkpt_job.err = 0;
+    return -1;
+}
+#endif /* THREADED_CHKPT */
+
+#ifdef INSURANCE
+/* open scratch slot 'which' (0 or 1) of the level store for writing */
+int
+create_scratchfile(which)
+int which;
+{
+    struct levstore *ls = &levstore[LEVSTORE_SCRATCH + which];
+
+    if (ls->mode != LS_CLOSED)
+        impossible("create_scratchfile: slot %d is already open", which);
+    ls->len = ls->pos = 0L;
+    ls->mode = LS_WRITE;
+    return LEVSTORE_FD0 + LEVSTORE_SCRATCH + which;
+}
+
+/* the journal goes with level 0 and has its name, ending in ".j" */
+STATIC_OVL char *
+chkpt_journal_name(file)
+char *file;
+{
+    Strcpy(file, lock);
+    set_levelfile_name(file, 0);
+    Strcpy(rindex(file, '.'), ".j");
+    return file;
+}
+
+STATIC_OVL void
+chkpt_forget(img)
+struct chkpt_image *img;
+{
+    if (img->buf)
+        free((genericptr_t) img->buf);
+    img->buf = (char *) 0;
+    img->len = img->size = 0L;
+    img->lev = -1;
+}
+
+/* level 'lev' is about to be rewritten in full or deleted; if the journal
+   has changes for it, they no longer apply, and neither do the others */
+void
+chkpt_discard(lev)
+int lev;
+{
+    char name[BUFSZ];
+
+    if (lev != 0 && lev != chkpt_images[1].lev)
+        return;
+    chkpt_forget(&chkpt_images[0]);
+    chkpt_forget(&chkpt_images[1]);
+    /* a journal left by an earlier game is of no use either */
+    if (chkpt_jlen || lev == 0)
+        (void) unlink(fqname(chkpt_journal_name(name), LEVELPREFIX, 0));
+    chkpt_jlen = 0L;
+}
+
+/* read a level file into an image */
+STATIC_OVL boolean
+chkpt_load(img, lev)
+struct chkpt_image *img;
+int lev;
+{
+    int fd;
+
+    if ((fd = open_levelfile(lev, (char *) 0)) < 0)
+        return FALSE;
+    if (!chkpt_slurp(img, fd))
+        return FALSE;
+    img->lev = lev;
+    return TRUE;
+}
+
+/* read the rest of an open file into an image, and close it */
+STATIC_OVL boolean
+chkpt_slurp(img, fd)
+struct chkpt_image *img;
+int fd;
+{
+    int n;
+
+    img->len = 0L;
+    do {
+        if (img->len == img->size) {
+            unsigned long newsize = max(img->size * 2L, LEVSTORE_CHUNK);
+            char *newbuf = (char *) alloc(newsize);
+
+            if (img->buf) {
+                (void) memcpy((genericptr_t) newbuf, (genericptr_t) img->buf,
+                              img->len);
+                free((genericptr_t) img->buf);
+            }
+            img->buf = newbuf;
+            img->size = newsize;
+        }
+        n = nhread(fd, (genericptr_t) &img->buf[img->len],
+                   (unsigned) (img->size - img->len));
+        if (n > 0)
+            img->len += (unsigned long) n;
+    } while (n > 0);
+    (void) nhclose(fd);
+    if (n < 0) {
+        chkpt_forget(img);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* append to the record being put together */
+STATIC_OVL void
+chkpt_put(ptr, len)
+genericptr_t ptr;
+unsigned long len;
+{
+    if (chkpt_reclen + len > chkpt_recsize) {
+        unsigned long newsize = max(chkpt_recsize * 2L, BUFSZ);
+        char *newrec;
+
+        while (newsize < chkpt_reclen + len)
+            newsize *= 2L;
+        newrec = (char *) alloc(newsize);
+        if (chkpt_rec) {
+            (void) memcpy((genericptr_t) newrec, (genericptr_t) chkpt_rec,
+                          chkpt_reclen);
+            free((genericptr_t) chkpt_rec);
+        }
+        chkpt_rec = newrec;
+        chkpt_recsize = newsize;
+    }
+    (void) memcpy((genericptr_t) &chkpt_rec[chkpt_reclen], ptr, len);
+    chkpt_reclen += len;
+}
+
+STATIC_OVL void
+chkpt_hunk(off, oldcnt, newcnt, data)
+unsigned long off, oldcnt, newcnt;
+const char *data;
+{
+    struct chkpt_hunk hunk;
+
+    hunk.off = off;
+    hunk.oldcnt = oldcnt;
+    hunk.newcnt = newcnt;
+    chkpt_put((genericptr_t) &hunk, (unsigned long) sizeof hunk);
+    chkpt_put((genericptr_t) data, newcnt);
+}
+
+/* append what changed between an image and the new contents of its level
+   file, as a part of the record; returns 0 if nothing did */
+STATIC_OVL int
+chkpt_diff(img, ls)
+struct chkpt_image *img;
+struct levstore *ls;
+{
+    struct chkpt_part part;
+    unsigned long partoff, i, start, last, common, pre, suf;
+    const char *o = img->buf, *n = ls->buf;
+
+    part.lev = img->lev;
+    part.nhunks = 0;
+    part.oldlen = img->len;
+    part.newlen = ls->len;
+    partoff = chkpt_reclen;
+    chkpt_put((genericptr_t) &part, (unsigned long) sizeof part);
+    if (img->len == ls->len) {
+        /* the usual case; only values changed, so send the ranges that
+           differ, running together those separated by a few bytes */
+        for (i = 0L; i < img->len;) {
+            if (i + CHKPT_BLOCK <= img->len
+                && !memcmp((genericptr_t) &o[i], (genericptr_t) &n[i],
+                           CHKPT_BLOCK)) {
+                i += CHKPT_BLOCK;
+                continue;
+            }
+            if (o[i] == n[i]) {
+                i++;
+                continue;
+            }
+            start = last = i;
+            for (i++; i < img->len && i - last <= CHKPT_GAP; i++)
+                if (o[i] != n[i])
+                    last = i;
+            chkpt_hunk(start, last + 1 - start, last + 1 - start, &n[start]);
+            part.nhunks++;
+            i = last + 1;
+        }
+    } else {
+        /* something was added or removed; send everything between the
+           part at the start that's the same and the part at the end */
+        common = min(img->len, ls->len);
+        for (pre = 0L; pre < common && o[pre] == n[pre]; pre++)
+            continue;
+        for (suf = 0L; suf < common - pre
+                       && o[img->len - 1 - suf] == n[ls->len - 1 - suf];
+             suf++)
+            continue;
+        chkpt_hunk(pre, img->len - pre - suf, ls->len - pre - suf, &n[pre]);
+        part.nhunks++;
+    }
+    if (!part.nhunks) {
+        chkpt_reclen = partoff;
+        return 0;
+    }
+    (void) memcpy((genericptr_t) &chkpt_rec[partoff], (genericptr_t) &part,
+                  sizeof part);
+    return 1;
+}
+
+/*
+ * Level 0 has been serialized into scratch slot 0 and level 'lev' into
+ * scratch slot 1; append the changes to the journal.  Returns TRUE when
+ * they should be written in full instead, because there's nothing to
+ * compare them with or the journal has grown bigger than they are.
+ */
+boolean
+chkpt_delta(lev, serial)
+int lev;
+long serial;
+{
+    struct levstore *ls[2];
+    struct chkpt_record rec;
+    struct chkpt_image tmp;
+    char name[BUFSZ];
+    int fd, i, nparts;
+
+    /* a checkpoint of the current level kept in memory can't be
+       recovered, so there's nothing on disk to bring up to date */
+    if (lev < MAXLINFO && levstore[lev].buf)
+        return FALSE;
+    ls[0] = &levstore[LEVSTORE_SCRATCH];
+    ls[1] = &levstore[LEVSTORE_SCRATCH + 1];
+    if (chkpt_images[1].lev != lev)
+        chkpt_discard(0);
+    if ((chkpt_images[0].lev < 0 && !chkpt_load(&chkpt_images[0], 0))
+        || (chkpt_images[1].lev < 0 && !chkpt_load(&chkpt_images[1], lev)))
+        return TRUE;
+
+    chkpt_reclen = 0L;
+    (void) memset((genericptr_t) &rec, 0, sizeof rec);
+    chkpt_put((genericptr_t) &rec, (unsigned long) sizeof rec);
+    nparts = 0;
+    for (i = 0; i < 2; i++)
+        nparts += chkpt_diff(&chkpt_images[i], ls[i]);
+    if (!nparts)
+        return FALSE;
+    if (chkpt_jlen + chkpt_reclen
+        > chkpt_images[0].len + chkpt_images[1].len)
+        return TRUE;
+    rec.magic = CHKPT_MAGIC;
+    rec.size = chkpt_reclen;
+    rec.serial = serial;
+    rec.pid = hackpid;
+    rec.nparts = nparts;
+    (void) memcpy((genericptr_t) chkpt_rec, (genericptr_t) &rec, sizeof rec);
+
+    fd = open(fqname(chkpt_journal_name(name), LEVELPREFIX, 0),
+              O_WRONLY | O_CREAT | O_APPEND | O_BINARY, FCMASK);
+    if (fd < 0)
+        return TRUE;
+    if (write(fd, (genericptr_t) chkpt_rec, (unsigned) chkpt_reclen)
+        != (int) chkpt_reclen) {
+        /* recover ignores a record that's cut short, but writing
+           the files in full will get rid of it anyway */
+        (void) close(fd);
+        return TRUE;
+    }
+    (void) close(fd);
+    chkpt_jlen += chkpt_reclen;
+
+    /* the new contents become the images to compare with next time;
+       the old images' buffers are reused for the next serialization */
+    for (i = 0; i < 2; i++) {
+        tmp = chkpt_images[i];
+        chkpt_images[i].buf = ls[i]->buf;
+        chkpt_images[i].len = ls[i]->len;
+        chkpt_images[i].size = ls[i]->size;
+        ls[i]->buf = tmp.buf;
+        ls[i]->size = tmp.size;
+        ls[i]->len = 0L;
+    }
+    return FALSE;
+}
+#endif /* INSURANCE */
+
 /* ----------  END LEVEL FILE HANDLING ----------- */
 
 /* ----------  BEGIN BONES FILE HANDLING ----------- */
@@ -881,6 +1773,10 @@ char **bonesid;
     fd = macopen(fq_bones, O_RDONLY | O_BINARY, BONE_TYPE);
 #else
     fd = open(fq_bones, O_RDONLY | O_BINARY, 0);
+#endif
+#ifdef MMAP_RESTORE
+    if (fd >= 0)
+        nhmap_open(fd);
 #endif
     return fd;
 }
@@ -964,7 +1860,7 @@ void
 save_savefile_name(fd)
 int fd;
 {
-    (void) write(fd, (genericptr_t) SAVEF, sizeof(SAVEF));
+    (void) nhwrite(fd, (genericptr_t) SAVEF, sizeof(SAVEF));
 }
 #endif
 
@@ -1034,6 +1930,10 @@ open_savefile()
     fd = macopen(fq_save, O_RDONLY | O_BINARY, SAVE_TYPE);
 #else
     fd = open(fq_save, O_RDONLY | O_BINARY, 0);
+#endif
+#ifdef MMAP_RESTORE
+    if (fd >= 0)
+        nhmap_open(fd);
 #endif
     return fd;
 }
@@ -1043,9 +1943,59 @@ int
 delete_savefile()
 {
     (void) unlink(fqname(SAVEF, SAVEPREFIX, 0));
+    update_save_catalog(FALSE);
     return 0; /* for restore_saved_game() (ex-xxxmain.c) test */
 }
 
+/* record the save file that was just written, or forget the one that was
+   just deleted, in the saved game catalog */
+void
+update_save_catalog(adding)
+boolean adding;
+{
+#ifdef SAVE_CATALOG
+    char file[BUFSZ], zfile[BUFSZ], fq_save[FQN_MAX_FILENAME + 8];
+    const char *p;
+    struct stat st;
+    struct savecat *ce = 0;
+
+    /* entries are by name within the save directory, and the file might
+       or might not have been compressed */
+    p = rindex(SAVEF, '/');
+    Strcpy(file, p ? p + 1 : SAVEF);
+    Strcpy(zfile, file);
+#ifdef COMPRESS_EXTENSION
+    Strcat(zfile, COMPRESS_EXTENSION);
+#endif
+    savecat_load();
+    savecat_remove(file);
+    savecat_remove(zfile);
+    if (adding) {
+        Strcpy(fq_save, fqname(SAVEF, SAVEPREFIX, 0));
+        if (stat(fq_save, &st) == 0) {
+            ce = savecat_enter(file, plname, &st);
+        } else {
+#ifdef COMPRESS_EXTENSION
+            Strcat(fq_save, COMPRESS_EXTENSION);
+            if (stat(fq_save, &st) == 0)
+                ce = savecat_enter(zfile, plname, &st);
+#endif
+        }
+        if (ce) {
+            Strcpy(ce->role, urole.filecode);
+            ce->depth = depth(&u.uz);
+            ce->turn = moves;
+            Strcpy(ce->when, yyyymmddhhmmss(getnow()));
+        }
+    }
+    if (savecat_changed)
+        savecat_store();
+    savecat_free();
+#else
+    nhUse(adding);
+#endif
+}
+
 /* try to open up a save file and prepare to restore it */
 int
 restore_saved_game()
@@ -1082,7 +2032,13 @@ const char *filename;
 
     Strcpy(SAVEF, filename);
 #ifdef COMPRESS_EXTENSION
-    SAVEF[strlen(SAVEF) - strlen(COMPRESS_EXTENSION)] = '\0';
+    {
+        /* internally compressed save files don't have the extension */
+        int ln = (int) strlen(SAVEF) - (int) strlen(COMPRESS_EXTENSION);
+
+        if (ln > 0 && !strcmp(&SAVEF[ln], COMPRESS_EXTENSION))
+            SAVEF[ln] = '\0';
+    }
 #endif
     nh_uncompress(SAVEF);
     if ((fd = open_savefile()) >= 0) {
@@ -1169,7 +2125,7 @@ get_saved_games()
         }
     }
 #endif
-#if defined(UNIX) && defined(QT_GRAPHICS)
+#ifdef UNIX
     /* posixly correct version */
     int myuid = getuid();
     DIR *dir;
@@ -1185,29 +2141,50 @@ get_saved_games()
                 return 0;
             result = (char **) alloc((n + 1) * sizeof(char *)); /* at most */
             (void) memset((genericptr_t) result, 0, (n + 1) * sizeof(char *));
+#ifdef SAVE_CATALOG
+            savecat_load();
+#endif
             for (i = 0, j = 0; i < n; i++) {
                 int uid;
                 char name[64]; /* more than PL_NSIZ */
                 struct dirent *entry = readdir(dir);
+#ifdef SAVE_CATALOG
+                struct savecat *ce;
+#endif
 
                 if (!entry)
                     break;
                 if (sscanf(entry->d_name, "%d%63s", &uid, name) == 2) {
+#ifdef SAVE_CATALOG
+                    if ((ce = savecat_find(entry->d_name)) != 0)
+                        ce->seen = TRUE;
+#endif
                     if (uid == myuid) {
                         char filename[BUFSZ];
                         char *r;
 
                         Sprintf(filename, "save/%d%s", uid, name);
+#ifdef SAVE_CATALOG
+                        r = savecat_plname(filename, ce);
+#else
                         r = plname_from_file(filename);
+#endif
                         if (r)
                             result[j++] = r;
                     }
                 }
             }
             closedir(dir);
+#ifdef SAVE_CATALOG
+            for (i = savecat_n - 1; i >= 0; i--)
+                if (!savecat[i].seen)
+                    savecat_remove(savecat[i].file);
+            if (savecat_changed)
+                savecat_store();
+#endif
         }
     }
-#endif
+#endif /* UNIX */
 #ifdef VMS
     Strcpy(plname, "*");
     set_savefile_name(FALSE);
@@ -1237,7 +2214,259 @@ char **saved;
             free((genericptr_t) saved[i++]);
         free((genericptr_t) saved);
     }
+#ifdef SAVE_CATALOG
+    savecat_free();
+#endif
+}
+
+#ifdef SELECTSAVED
+/* menu text for one of the names from get_saved_games() */
+char *
+describe_saved_game(name, buf)
+const char *name;
+char *buf;
+{
+#ifdef SAVE_CATALOG
+    char file[BUFSZ], zfile[BUFSZ];
+    int i;
+
+    /* only this player's own file, as set_savefile_name() names it; a
+       bare uid prefix would let uid 1 match another player's "1000bob" */
+    Sprintf(file, "%d%s", (int) getuid(), name);
+    regularize(file);
+    Strcpy(zfile, file);
+#ifdef COMPRESS_EXTENSION
+    Strcat(zfile, COMPRESS_EXTENSION);
+#endif
+    for (i = 0; i < savecat_n; i++) {
+        struct savecat *ce = &savecat[i];
+        const char *w = ce->when;
+
+        if ((strcmp(ce->file, file) && strcmp(ce->file, zfile))
+            || strcmp(ce->name, name) || !ce->depth)
+            continue;
+        Sprintf(buf, "%s (%s, Dlvl:%d, T:%ld, %.4s-%.2s-%.2s %.2s:%.2s)",
+                name, ce->role, ce->depth, ce->turn,
+                w, w + 4, w + 6, w + 8, w + 10);
+        return buf;
+    }
+#endif
+    return strcpy(buf, name);
 }
+#endif /* SELECTSAVED */
+
+#ifdef SAVE_CATALOG
+STATIC_PTR int CFDECLSPEC
+savecat_cmp(p, q)
+const genericptr p;
+const genericptr q;
+{
+    return strcmp(((const struct savecat *) p)->file,
+                  ((const struct savecat *) q)->file);
+}
+
+/* read the catalog; if it's missing or unreadable, start an empty one */
+STATIC_OVL void
+savecat_load()
+{
+    FILE *fp;
+    char line[BUFSZ * 2], *f[8], *p;
+    struct savecat *ce;
+    int k;
+
+    savecat_free();
+    if (!(fp = fopen(fqname(SAVE_CATALOG, SAVEPREFIX, 0), "r")))
+        return;
+    if (!fgets(line, sizeof line, fp) || strncmp(line, SAVECAT_MAGIC,
+                                                 sizeof SAVECAT_MAGIC - 1)) {
+        savecat_changed = TRUE; /* replace it */
+        (void) fclose(fp);
+        return;
+    }
+    while (fgets(line, sizeof line, fp)) {
+        if ((p = index(line, '\n')) != 0)
+            *p = '\0';
+        /* file, mtime, size, role, depth, turn, when, name */
+        for (k = 0, p = line; k < 8; k++) {
+            f[k] = p;
+            if (k < 7 && (p = index(p, '\t')) != 0)
+                *p++ = '\0';
+            else if (k < 7)
+                break;
+        }
+        if (k < 8 || !*f[0] || !*f[7]) {
+            savecat_changed = TRUE; /* drop the damaged line */
+            continue;
+        }
+        ce = savecat_new();
+        ce->file = dupstr(f[0]);
+        ce->name = dupstr(f[7]);
+        ce->mtime = atol(f[1]);
+        ce->size = atol(f[2]);
+        (void) strncpy(ce->role, f[3], sizeof ce->role - 1);
+        ce->role[sizeof ce->role - 1] = '\0';
+        ce->depth = atoi(f[4]);
+        ce->turn = atol(f[5]);
+        (void) strncpy(ce->when, f[6], sizeof ce->when - 1);
+        ce->when[sizeof ce->when - 1] = '\0';
+        ce->seen = FALSE;
+    }
+    (void) fclose(fp);
+    qsort((genericptr_t) savecat, savecat_n, sizeof *savecat, savecat_cmp);
+    savecat_sorted = savecat_n;
+}
+
+/* write the catalog back out */
+STATIC_OVL void
+savecat_store()
+{
+    FILE *fp;
+    char tmpname[BUFSZ], fq_cat[FQN_MAX_FILENAME];
+    int i;
+
+    Strcpy(fq_cat, fqname(SAVE_CATALOG, SAVEPREFIX, 0));
+    Sprintf(tmpname, "%s.%d", SAVE_CATALOG, (int) getpid());
+    if (!(fp = fopen(fqname(tmpname, SAVEPREFIX, 0), "w")))
+        return;
+    (void) fprintf(fp, "%s\n", SAVECAT_MAGIC);
+    for (i = 0; i < savecat_n; i++) {
+        struct savecat *ce = &savecat[i];
+
+        (void) fprintf(fp, "%s\t%ld\t%ld\t%s\t%d\t%ld\t%s\t%s\n", ce->file,
+                       ce->mtime, ce->size, ce->role, ce->depth, ce->turn,
+                       ce->when, ce->name);
+    }
+    if (fclose(fp) == EOF || rename(fqname(tmpname, SAVEPREFIX, 0), fq_cat))
+        (void) unlink(fqname(tmpname, SAVEPREFIX, 0));
+    else
+        savecat_changed = FALSE;
+}
+
+STATIC_OVL void
+savecat_free()
+{
+    int i;
+
+    for (i = 0; i < savecat_n; i++) {
+        free((genericptr_t) savecat[i].file);
+        free((genericptr_t) savecat[i].name);
+    }
+    if (savecat)
+        free((genericptr_t) savecat);
+    savecat = (struct savecat *) 0;
+    savecat_n = savecat_size = savecat_sorted = 0;
+    savecat_changed = FALSE;
+}
+
+/* make room for another entry */
+STATIC_OVL struct savecat *
+savecat_new()
+{
+    if (savecat_n == savecat_size) {
+        struct savecat *newcat;
+
+        savecat_size = savecat_size ? savecat_size * 2 : 64;
+        newcat = (struct savecat *) alloc(savecat_size * sizeof *newcat);
+        if (savecat_n)
+            (void) memcpy((genericptr_t) newcat, (genericptr_t) savecat,
+                          savecat_n * sizeof *newcat);
+        if (savecat)
+            free((genericptr_t) savecat);
+        savecat = newcat;
+    }
+    return &savecat[savecat_n++];
+}
+
+/* look up a save file's entry */
+STATIC_OVL struct savecat *
+savecat_find(file)
+const char *file;
+{
+    struct savecat key, *ce;
+    int i;
+
+    key.file = (char *) file;
+    if (savecat_sorted
+        && (ce = (struct savecat *) bsearch((genericptr_t) &key,
+                                            (genericptr_t) savecat,
+                                            savecat_sorted, sizeof *savecat,
+                                            savecat_cmp)) != 0)
+        return ce;
+    /* entries added since the catalog was read aren't in order */
+    for (i = savecat_sorted; i < savecat_n; i++)
+        if (!strcmp(savecat[i].file, file))
+            return &savecat[i];
+    return (struct savecat *) 0;
+}
+
+/* add or replace a save file's entry; role and so forth are left unknown */
+STATIC_OVL struct savecat *
+savecat_enter(file, name, st)
+const char *file, *name;
+struct stat *st;
+{
+    struct savecat *ce;
+
+    if ((ce = savecat_find(file)) != 0) {
+        free((genericptr_t) ce->name);
+    } else {
+        ce = savecat_new();
+        ce->file = dupstr(file);
+    }
+    ce->name = dupstr(name);
+    ce->mtime = (long) st->st_mtime;
+    ce->size = (long) st->st_size;
+    ce->role[0] = '\0';
+    ce->depth = 0;
+    ce->turn = 0L;
+    Strcpy(ce->when, yyyymmddhhmmss(st->st_mtime));
+    ce->seen = TRUE;
+    savecat_changed = TRUE;
+    return ce;
+}
+
+STATIC_OVL void
+savecat_remove(file)
+const char *file;
+{
+    struct savecat *ce = savecat_find(file);
+    int i;
+
+    if (!ce)
+        return;
+    i = (int) (ce - savecat);
+    free((genericptr_t) ce->file);
+    free((genericptr_t) ce->name);
+    /* closing the gap keeps the sorted part sorted */
+    if (i < savecat_n - 1)
+        (void) memmove((genericptr_t) ce, (genericptr_t) (ce + 1),
+                       (savecat_n - i - 1) * sizeof *ce);
+    savecat_n--;
+    if (i < savecat_sorted)
+        savecat_sorted--;
+    savecat_changed = TRUE;
+}
+
+/* character name for a save file, from its catalog entry when that's up
+   to date, otherwise from the file itself */
+STATIC_OVL char *
+savecat_plname(filename, ce)
+const char *filename; /* "save/<uid><name>" */
+struct savecat *ce;   /* its entry, if any */
+{
+    struct stat st;
+    char *r;
+
+    if (stat(fqname(filename, SAVEPREFIX, 0), &st) < 0)
+        return (char *) 0;
+    if (ce && ce->mtime == (long) st.st_mtime && ce->size == (long) st.st_size)
+        return dupstr(ce->name);
+    if ((r = plname_from_file(filename)) != 0
+        && stat(fqname(filename, SAVEPREFIX, 0), &st) == 0)
+        (void) savecat_enter(filename + 5, r, &st);
+    return r;
+}
+#endif /* SAVE_CATALOG */
 
 /* ----------  END SAVE FILE HANDLING ----------- */
 
@@ -1431,6 +2660,10 @@ const char *filename UNUSED_if_not_COMPRESS;
 #pragma unused(filename)
 #endif
 #else
+#ifdef LZCOMP
+    if (sfsaveinfo.sfi1 & SFI1_LZCOMP)
+        return; /* already compressed */
+#endif
     docompress_file(filename, FALSE);
 #endif
 }
@@ -2425,6 +3658,13 @@ char *origbuf;
         /* note: right now bones_pools==0 is the same as bones_pools==1,
            but we could change that and make bones_pools==0 become an
            indicator to suppress bones usage altogether */
+    } else if (src == SET_IN_SYS && match_varname(buf, "LEVELSTORE", 10)) {
+        n = atoi(bufp);
+        sysopt.levelstore = (n <= 0) ? 0 : n;
+    } else if (src == SET_IN_SYS
+               && match_varname(buf, "CHECKPOINT_DELTAS", 17)) {
+        n = atoi(bufp);
+        sysopt.chkptdeltas = (n <= 0) ? 0 : n;
     } else if (src == SET_IN_SYS && match_varname(buf, "SUPPORT", 7)) {
         if (sysopt.support)
             free((genericptr_t) sysopt.support);
@@ -3589,7 +4829,6 @@ recover_savefile()
 {
     int gfd, lfd, sfd;
     int lev, savelev, hpid, pltmpsiz;
-    xchar levc;
     struct version_info version_data;
     int processed[256];
     char savename[SAVESIZE], errbuf[BUFSZ];
@@ -3598,6 +4837,9 @@ recover_savefile()
 
     for (lev = 0; lev < 256; lev++)
         processed[lev] = 0;
+#ifdef INSURANCE
+    chkpt_replay();
+#endif
 
     /* level 0 file contains:
      *  pid of creating process (ignored here)
@@ -3612,14 +4854,14 @@ recover_savefile()
         raw_printf("%s\n", errbuf);
         return FALSE;
     }
-    if (read(gfd, (genericptr_t) &hpid, sizeof hpid) != sizeof hpid) {
+    if (nhread(gfd, (genericptr_t) &hpid, sizeof hpid) != sizeof hpid) {
         raw_printf("\n%s\n%s\n",
             "Checkpoint data incompletely written or subsequently clobbered.",
                    "Recovery impossible.");
         (void) nhclose(gfd);
         return FALSE;
     }
-    if (read(gfd, (genericptr_t) &savelev, sizeof(savelev))
+    if (nhread(gfd, (genericptr_t) &savelev, sizeof(savelev))
         != sizeof(savelev)) {
         raw_printf(
          "\nCheckpointing was not in effect for %s -- recovery impossible.\n",
@@ -3627,14 +4869,14 @@ recover_savefile()
         (void) nhclose(gfd);
         return FALSE;
     }
-    if ((read(gfd, (genericptr_t) savename, sizeof savename)
+    if ((nhread(gfd, (genericptr_t) savename, sizeof savename)
          != sizeof savename)
-        || (read(gfd, (genericptr_t) &version_data, sizeof version_data)
+        || (nhread(gfd, (genericptr_t) &version_data, sizeof version_data)
             != sizeof version_data)
-        || (read(gfd, (genericptr_t) &sfi, sizeof sfi) != sizeof sfi)
-        || (read(gfd, (genericptr_t) &pltmpsiz, sizeof pltmpsiz)
+        || (nhread(gfd, (genericptr_t) &sfi, sizeof sfi) != sizeof sfi)
+        || (nhread(gfd, (genericptr_t) &pltmpsiz, sizeof pltmpsiz)
             != sizeof pltmpsiz) || (pltmpsiz > PL_NSIZ)
-        || (read(gfd, (genericptr_t) &tmpplbuf, pltmpsiz) != pltmpsiz)) {
+        || (nhread(gfd, (genericptr_t) &tmpplbuf, pltmpsiz) != pltmpsiz)) {
         raw_printf("\nError reading %s -- can't recover.\n", lock);
         (void) nhclose(gfd);
         return FALSE;
@@ -3733,9 +4975,8 @@ recover_savefile()
             lfd = open_levelfile(lev, (char *) 0);
             if (lfd >= 0) {
                 /* any or all of these may not exist */
-                levc = (xchar) lev;
-                write(sfd, (genericptr_t) &levc, sizeof(levc));
-                if (!copy_bytes(lfd, sfd)) {
+                if (!write_levc(sfd, (xchar) lev, &sfi)
+                    || !copy_bytes(lfd, sfd)) {
                     (void) nhclose(lfd);
                     (void) nhclose(sfd);
                     delete_savefile();
@@ -3767,6 +5008,49 @@ recover_savefile()
     return TRUE;
 }
 
+/* write the level number which goes in front of each level in the save
+   file as bwrite() would have, according to the file's save options; see
+   recover's write_levc() */
+STATIC_OVL boolean
+write_levc(fd, levc, sfi)
+int fd;
+xchar levc;
+struct savefile_info *sfi;
+{
+    unsigned char in[8 + sizeof levc], out[2 * sizeof in + 4];
+    unsigned long crc;
+    unsigned n = 0, len = 0, i, run;
+
+    if (sfi->sfi1 & SFI1_CRC32C) {
+        crc = crc32c(0L, (genericptr_t) &levc, sizeof levc);
+        for (i = 0; i < 4; i++) {
+            in[i] = (unsigned char) ((sizeof levc >> (8 * i)) & 0xff);
+            in[4 + i] = (unsigned char) ((crc >> (8 * i)) & 0xff);
+        }
+        n = 8;
+    }
+    (void) memcpy((genericptr_t) &in[n], (genericptr_t) &levc, sizeof levc);
+    n += sizeof levc;
+    if (sfi->sfi1 & SFI1_LZCOMP) {
+        out[len++] = (unsigned char) n, out[len++] = 0;
+        out[len++] = 0, out[len++] = 0; /* stored as is */
+    }
+    if (sfi->sfi1 & SFI1_ZEROCOMP) {
+        for (i = 0; i < n; i++) {
+            out[len++] = in[i];
+            if (!in[i]) {
+                for (run = 0; i + 1 < n && !in[i + 1]; i++)
+                    run++;
+                out[len++] = (unsigned char) run;
+            }
+        }
+    } else {
+        (void) memcpy((genericptr_t) &out[len], (genericptr_t) in, n);
+        len += n;
+    }
+    return (boolean) (write(fd, (genericptr_t) out, len) == (int) len);
+}
+
 boolean
 copy_bytes(ifd, ofd)
 int ifd, ofd;
@@ -3775,7 +5059,7 @@ int ifd, ofd;
     int nfrom, nto;
 
     do {
-        nfrom = read(ifd, buf, BUFSIZ);
+        nfrom = nhread(ifd, buf, BUFSIZ);
         nto = write(ofd, buf, nfrom);
         if (nto != nfrom)
             return FALSE;
@@ -3783,6 +5067,162 @@ int ifd, ofd;
     return TRUE;
 }
 
+#ifdef INSURANCE
+/* check, then apply, the parts of one checkpoint journal record, as
+   recover's apply_record() does; returns its size, or 0 if it's
+   incomplete or doesn't fit the level files */
+STATIC_OVL unsigned long
+chkpt_apply(rec, end, hpid)
+char *rec, *end;
+int hpid;
+{
+    struct chkpt_record hdr;
+    struct chkpt_part part;
+    struct chkpt_hunk hunk;
+    struct chkpt_image *img;
+    char *p, *q, *newbuf = (char *) 0;
+    unsigned long pos, outlen;
+    int pass, i, j, f;
+
+    if ((unsigned long) (end - rec) < sizeof hdr)
+        return 0L;
+    (void) memcpy((genericptr_t) &hdr, (genericptr_t) rec, sizeof hdr);
+    if (hdr.magic != CHKPT_MAGIC || hdr.pid != hpid
+        || hdr.size < sizeof hdr || hdr.size > (unsigned long) (end - rec))
+        return 0L;
+    end = rec + hdr.size;
+    /* the first pass only makes sure everything fits */
+    for (pass = 0; pass < 2; pass++) {
+        p = rec + sizeof hdr;
+        for (i = 0; i < hdr.nparts; i++) {
+            if ((unsigned long) (end - p) < sizeof part)
+                return 0L;
+            (void) memcpy((genericptr_t) &part, (genericptr_t) p,
+                          sizeof part);
+            p += sizeof part;
+            for (f = 0; f < 2; f++)
+                if (chkpt_images[f].lev == part.lev
+                    || chkpt_images[f].lev < 0)
+                    break;
+            if (f == 2 || part.lev < 0 || part.lev >= MAXLINFO)
+                return 0L;
+            img = &chkpt_images[f];
+            if (img->lev < 0 && !chkpt_load(img, part.lev))
+                return 0L;
+            if (img->len != part.oldlen)
+                return 0L;
+            if (pass)
+                newbuf = (char *) alloc(part.newlen + 1);
+            pos = outlen = 0L;
+            for (j = 0; j < part.nhunks; j++) {
+                if ((unsigned long) (end - p) < sizeof hunk)
+                    return 0L;
+                (void) memcpy((genericptr_t) &hunk, (genericptr_t) p,
+                              sizeof hunk);
+                q = p + sizeof hunk;
+                if (hunk.off < pos || hunk.off > part.oldlen
+                    || hunk.oldcnt > part.oldlen - hunk.off
+                    || hunk.newcnt > (unsigned long) (end - q)
+                    || outlen + (hunk.off - pos) + hunk.newcnt > part.newlen)
+                    return 0L;
+                if (pass) {
+                    (void) memcpy((genericptr_t) &newbuf[outlen],
+                                  (genericptr_t) &img->buf[pos],
+                                  hunk.off - pos);
+                    outlen += hunk.off - pos;
+                    (void) memcpy((genericptr_t) &newbuf[outlen],
+                                  (genericptr_t) q, hunk.newcnt);
+                    outlen += hunk.newcnt;
+                } else {
+                    outlen += hunk.off - pos + hunk.newcnt;
+                }
+                pos = hunk.off + hunk.oldcnt;
+                p = q + hunk.newcnt;
+            }
+            if (outlen + (part.oldlen - pos) != part.newlen)
+                return 0L;
+            if (pass) {
+                (void) memcpy((genericptr_t) &newbuf[outlen],
+                              (genericptr_t) &img->buf[pos],
+                              part.oldlen - pos);
+                free((genericptr_t) img->buf);
+                img->buf = newbuf;
+                img->len = part.newlen;
+                img->size = part.newlen + 1;
+            }
+        }
+    }
+    return hdr.size;
+}
+
+/* bring level 0 and the current level up to date with the checkpoint
+   journal, if there is one, before recovering from them */
+STATIC_OVL void
+chkpt_replay()
+{
+    struct chkpt_image journal;
+    char name[BUFSZ], tmpname[2][FQN_MAX_FILENAME + 4];
+    char *rec, *end;
+    unsigned long n;
+    int fd, f, hpid;
+    boolean ok = TRUE;
+
+    fd = open(fqname(chkpt_journal_name(name), LEVELPREFIX, 0),
+              O_RDONLY | O_BINARY, 0);
+    if (fd < 0)
+        return; /* none, usually */
+    journal.buf = (char *) 0;
+    journal.size = 0L;
+    if (!chkpt_slurp(&journal, fd))
+        return;
+    if (!chkpt_load(&chkpt_images[0], 0)
+        || chkpt_images[0].len < sizeof hpid) {
+        chkpt_forget(&journal);
+        chkpt_forget(&chkpt_images[0]);
+        return; /* recover_savefile() will complain about this */
+    }
+    (void) memcpy((genericptr_t) &hpid, (genericptr_t) chkpt_images[0].buf,
+                  sizeof hpid);
+    end = journal.buf + journal.len;
+    for (rec = journal.buf; rec < end; rec += n)
+        if (!(n = chkpt_apply(rec, end, hpid)))
+            break;
+    chkpt_forget(&journal);
+
+    /* write both files before replacing either */
+    for (f = 0; f < 2; f++) {
+        if (chkpt_images[f].lev < 0)
+            continue;
+        set_levelfile_name(lock, chkpt_images[f].lev);
+        Sprintf(tmpname[f], "%s.new", fqname(lock, LEVELPREFIX, 0));
+        fd = open(tmpname[f], O_WRONLY | O_CREAT | O_TRUNC | O_BINARY,
+                  FCMASK);
+        if (fd < 0 || write(fd, (genericptr_t) chkpt_images[f].buf,
+                            (unsigned) chkpt_images[f].len)
+                          != (int) chkpt_images[f].len)
+            ok = FALSE;
+        if (fd >= 0)
+            (void) close(fd);
+    }
+    for (f = 0; f < 2; f++) {
+        if (chkpt_images[f].lev < 0)
+            continue;
+        if (ok) {
+            set_levelfile_name(lock, chkpt_images[f].lev);
+            (void) unlink(fqname(lock, LEVELPREFIX, 0));
+            if (rename(tmpname[f], fqname(lock, LEVELPREFIX, 0)) < 0)
+                ok = FALSE;
+        }
+        (void) unlink(tmpname[f]);
+        chkpt_forget(&chkpt_images[f]);
+    }
+    if (ok)
+        (void) unlink(fqname(chkpt_journal_name(name), LEVELPREFIX, 0));
+    else
+        raw_printf("Cannot apply %s; recovering without it.", name);
+}
+#endif /* INSURANCE */
+
 /* ----------  END INTERNAL RECOVER ----------- */
 #endif /*SELF_RECOVER*/
 
@@ -906,6 +906,361 @@ int wiz_debug_cmd_traveldisplay()
 }
 #endif /* DEBUG */
 
+/*
+ * A breadth-first search outward from a travel destination.  The search
+ * stops when it reaches the hero, but can be resumed from the same spot
+ * to find the way from somewhere else.
+ */
+struct travel_search {
+    xchar travel[COLNO][ROWNO]; /* search radius at which spot was reached */
+    schar from[COLNO][ROWNO];   /* direction it was reached in */
+    xchar stepx[2][COLNO * ROWNO];
+    xchar stepy[2][COLNO * ROWNO];
+    int n, nn;        /* spots in current and next ring */
+    int set;          /* which stepx/stepy holds the current ring */
+    int radius;       /* search radius */
+    int i, dir;       /* where we are in the current ring */
+    boolean repeated; /* stepx/y[set][i] is already queued for next ring */
+};
+
+/*
+ * What a travel search depends on, besides the hero's position.  Two
+ * searches from the same place give the same answers if all of this
+ * matches.
+ */
+struct travel_spot {
+    schar typ;
+    uchar flags;
+    uchar bits;
+};
+#define TS_KNOWN 0x01 /* seen, or unseen but in line of sight */
+#define TS_BOULDER 0x02
+#define TS_TRAP 0x04 /* seen trap */
+
+struct travel_key {
+    d_level lev;
+    int run, monnum, squeeze;
+    unsigned props;
+};
+
+/*
+ * The last couple of searches made from travel destinations; a multi-turn
+ * travel uses them to find each step without searching again.  When
+ * the destination can't be reached, travel alternates between it and a
+ * guessed spot near it, hence two.
+ */
+static struct travel_map {
+    xchar tx, ty; /* search started here; tx == 0 for unused */
+    long used;
+    struct travel_key key;
+    struct travel_spot spots[COLNO][ROWNO];
+    struct travel_search search;
+} travel_maps[2];
+static long travel_map_uses = 0L;
+
+STATIC_DCL void FDECL(start_travel_search,
+                      (struct travel_search *, XCHAR_P, XCHAR_P));
+STATIC_DCL boolean FDECL(continue_travel_search,
+                         (struct travel_search *, int, XCHAR_P, XCHAR_P,
+                          BOOLEAN_P, xchar *, xchar *));
+STATIC_DCL boolean NDECL(travel_map_usable);
+STATIC_DCL void FDECL(get_travel_key, (struct travel_key *));
+STATIC_DCL void FDECL(get_travel_spots, (struct travel_spot[COLNO][ROWNO]));
+STATIC_DCL struct travel_search *FDECL(find_travel_map, (XCHAR_P, XCHAR_P));
+
+STATIC_OVL void
+start_travel_search(ts, tx, ty)
+struct travel_search *ts;
+xchar tx, ty;
+{
+    (void) memset((genericptr_t) ts->travel, 0, sizeof ts->travel);
+    ts->stepx[0][0] = tx;
+    ts->stepy[0][0] = ty;
+    ts->n = 1;
+    ts->nn = 0;
+    ts->set = 0;
+    ts->radius = 1;
+    ts->i = ts->dir = 0;
+    ts->repeated = FALSE;
+}
+
+/*
+ * Carry on with search ts until it reaches <ux,uy>; returns TRUE with
+ * the spot it was reached from in *fromx,*fromy, or FALSE if the search
+ * runs out of places to go.  If keep is set, <ux,uy> is taken into the
+ * search like any other spot so that it can be resumed afterwards.
+ */
+STATIC_OVL boolean
+continue_travel_search(ts, mode, ux, uy, keep, fromx, fromy)
+struct travel_search *ts;
+int mode;
+xchar ux, uy;
+boolean keep;
+xchar *fromx, *fromy;
+{
+    static int ordered[] = { 0, 2, 4, 6, 1, 3, 5, 7 };
+    /* no diagonal movement for grid bugs */
+    int dirmax = NODIAG(u.umonnum) ? 4 : 8;
+    int x, y, nx, ny;
+
+    while (ts->n != 0) {
+        for (; ts->i < ts->n; ts->i++, ts->dir = 0, ts->repeated = FALSE) {
+            x = ts->stepx[ts->set][ts->i];
+            y = ts->stepy[ts->set][ts->i];
+
+            for (; ts->dir < dirmax; ts->dir++) {
+                nx = x + xdir[ordered[ts->dir]];
+                ny = y + ydir[ordered[ts->dir]];
+
+                /*
+                 * When guessing and trying to travel as close as possible
+                 * to an unreachable target space, don't include spaces
+                 * that would never be picked as a guessed target in the
+                 * travel matrix describing hero-reachable spaces.
+                 * This stops travel from getting confused and moving
+                 * the hero back and forth in certain degenerate
+                 * configurations of sight-blocking obstacles, e.g.
+                 *
+                 *  T         1. Dig this out and carry enough to not be
+                 *   ####       able to squeeze through diagonal gaps.
+                 *   #--.---    Stand at @ and target travel at space T.
+                 *    @.....
+                 *    |.....
+                 *
+                 *  T         2. couldsee() marks spaces marked a and x
+                 *   ####       as eligible guess spaces to move the hero
+                 *   a--.---    towards.  Space a is closest to T, so it
+                 *    @xxxxx    gets chosen.  Travel system moves @ right
+                 *    |xxxxx    to travel to space a.
+                 *
+                 *  T         3. couldsee() marks spaces marked b, c and x
+                 *   ####       as eligible guess spaces to move the hero
+                 *   a--c---    towards.  Since findtravelpath() is called
+                 *    b@xxxx    repeatedly during travel, it doesn't
+                 *    |xxxxx    remember that it wanted to go to space a,
+                 *              so in comparing spaces b and c, b is
+                 *              chosen, since it seems like the closest
+                 *              eligible space to T. Travel system moves @
+                 *              left to go to space b.
+                 *
+                 *            4. Go to 2.
+                 *
+                 * By limiting the travel matrix here, space a in the
+                 * example above is never included in it, preventing
+                 * the cycle.
+                 */
+                if (!isok(nx, ny)
+                    || ((mode == TRAVP_GUESS) && !couldsee(nx, ny)))
+                    continue;
+                if ((!Passes_walls && !can_ooze(&youmonst)
+                     && closed_door(x, y)) || sobj_at(BOULDER, x, y)
+                    || test_move(x, y, nx-x, ny-y, TEST_TRAP)) {
+                    /* closed doors and boulders usually
+                     * cause a delay, so prefer another path */
+                    if (ts->travel[x][y] > ts->radius - 3) {
+                        if (!ts->repeated) {
+                            ts->stepx[1 - ts->set][ts->nn] = x;
+                            ts->stepy[1 - ts->set][ts->nn] = y;
+                            /* don't change travel matrix! */
+                            ts->nn++;
+                            ts->repeated = TRUE;
+                        }
+                        continue;
+                    }
+                }
+                if (test_move(x, y, nx - x, ny - y, TEST_TRAV)
+                    && (levl[nx][ny].seenv
+                        || (!Blind && couldsee(nx, ny)))) {
+                    if (nx == ux && ny == uy && !keep) {
+                        if (mode == TRAVP_TRAVEL || mode == TRAVP_VALID) {
+                            *fromx = x;
+                            *fromy = y;
+                            return TRUE;
+                        }
+                    } else if (!ts->travel[nx][ny]) {
+                        ts->stepx[1 - ts->set][ts->nn] = nx;
+                        ts->stepy[1 - ts->set][ts->nn] = ny;
+                        ts->travel[nx][ny] = ts->radius;
+                        ts->from[nx][ny] = ordered[ts->dir];
+                        ts->nn++;
+                        if (nx == ux && ny == uy) {
+                            ts->dir++; /* resume with the next direction */
+                            *fromx = x;
+                            *fromy = y;
+                            return TRUE;
+                        }
+                    }
+                }
+            }
+        }
+
+#ifdef DEBUG
+        if (trav_debug) {
+            int i;
+
+            /* Use of warning glyph is arbitrary. It stands out. */
+            tmp_at(DISP_ALL, warning_to_glyph(1));
+            for (i = 0; i < ts->nn; ++i) {
+                tmp_at(ts->stepx[1 - ts->set][i], ts->stepy[1 - ts->set][i]);
+            }
+            delay_output();
+            if (flags.runmode == RUN_CRAWL) {
+                delay_output();
+                delay_output();
+            }
+            tmp_at(DISP_END, 0);
+        }
+#endif /* DEBUG */
+
+        ts->n = ts->nn;
+        ts->nn = 0;
+        ts->set = 1 - ts->set;
+        ts->radius++;
+        ts->i = 0;
+    }
+    return FALSE;
+}
+
+/*
+ * Whether a saved travel search can stand in for a new one.  Things that
+ * make test_move() depend on where the hero is, or on monsters, rule it
+ * out: being on a trap or pool that travel would otherwise avoid, being
+ * in a shop or its broken door, and long worms' tails.
+ */
+STATIC_OVL boolean
+travel_map_usable()
+{
+    struct trap *t;
+    struct monst *mtmp;
+
+#ifdef DEBUG
+    if (trav_debug)
+        return FALSE; /* show the search every time */
+#endif
+    if (*u.ushops || (IS_DOOR(levl[u.ux][u.uy].typ)
+                      && levl[u.ux][u.uy].doormask == D_BROKEN))
+        return FALSE;
+    if (context.run == 8
+        && (((t = t_at(u.ux, u.uy)) != 0 && t->tseen)
+            || (!Levitation && !Flying && !is_clinger(youmonst.data)
+                && is_pool_or_lava(u.ux, u.uy)
+                && levl[u.ux][u.uy].seenv)))
+        return FALSE;
+    for (mtmp = fmon; mtmp; mtmp = mtmp->nmon)
+        if (mtmp->wormno && !DEADMONSTER(mtmp) && count_wsegs(mtmp))
+            return FALSE;
+    return TRUE;
+}
+
+/* the hero's side of what a travel search depends on */
+STATIC_OVL void
+get_travel_key(key)
+struct travel_key *key;
+{
+    struct obj *obj;
+    unsigned props = 0;
+
+    (void) memset((genericptr_t) key, 0, sizeof (struct travel_key));
+    key->lev = u.uz;
+    key->run = context.run;
+    key->monnum = u.umonnum;
+    key->squeeze = cant_squeeze_thru(&youmonst);
+    if (Passes_walls)
+        props |= 0x0001;
+    if (can_ooze(&youmonst))
+        props |= 0x0002;
+    if (Underwater)
+        props |= 0x0004;
+    if (Blind)
+        props |= 0x0008;
+    if (Hallucination)
+        props |= 0x0010;
+    if (Levitation)
+        props |= 0x0020;
+    if (Flying)
+        props |= 0x0040;
+    if (Sokoban)
+        props |= 0x0080;
+    if (carrying(PICK_AXE) || carrying(DWARVISH_MATTOCK)
+        || ((obj = carrying(WAN_DIGGING)) != 0
+            && !objects[obj->otyp].oc_name_known))
+        props |= 0x0100;
+    if (flags.autodig && !context.nopick && uwep && is_pick(uwep))
+        props |= 0x0200;
+    key->props = props;
+}
+
+/* the map's side of what a travel search depends on */
+STATIC_OVL void
+get_travel_spots(spots)
+struct travel_spot spots[COLNO][ROWNO];
+{
+    struct obj *obj;
+    struct trap *t;
+    struct rm *lev;
+    boolean thru_rock = (Passes_walls || passes_bars(youmonst.data)
+                         || (tunnels(youmonst.data)
+                             && !needspick(youmonst.data)));
+    int x, y;
+
+    for (x = 0; x < COLNO; x++)
+        for (y = 0; y < ROWNO; y++) {
+            lev = &levl[x][y];
+            spots[x][y].typ = lev->typ;
+            spots[x][y].flags = lev->flags;
+            /* line of sight only matters for spots that travel could
+               go through */
+            if (lev->seenv
+                || (!Blind && couldsee(x, y)
+                    && (thru_rock
+                        || !(IS_ROCK(lev->typ) || lev->typ == IRONBARS))))
+                spots[x][y].bits = TS_KNOWN;
+            else
+                spots[x][y].bits = 0;
+        }
+    for (obj = fobj; obj; obj = obj->nobj)
+        if (obj->otyp == BOULDER)
+            spots[obj->ox][obj->oy].bits |= TS_BOULDER;
+    for (t = ftrap; t; t = t->ntrap)
+        if (t->tseen)
+            spots[t->tx][t->ty].bits |= TS_TRAP;
+}
+
+/* return a search from <tx,ty>, reusing a saved one if it's still good */
+STATIC_OVL struct travel_search *
+find_travel_map(tx, ty)
+xchar tx, ty;
+{
+    static struct travel_spot spots[COLNO][ROWNO];
+    struct travel_key key;
+    struct travel_map *tm, *oldest = &travel_maps[0];
+    int i;
+
+    get_travel_key(&key);
+    get_travel_spots(spots);
+    for (i = 0; i < SIZE(travel_maps); i++) {
+        tm = &travel_maps[i];
+        if (tm->tx == tx && tm->ty == ty
+            && !memcmp((genericptr_t) &tm->key, (genericptr_t) &key,
+                       sizeof key)
+            && !memcmp((genericptr_t) tm->spots, (genericptr_t) spots,
+                       sizeof spots)) {
+            tm->used = ++travel_map_uses;
+            return &tm->search;
+        }
+        if (tm->used < oldest->used)
+            oldest = tm;
+    }
+    tm = oldest;
+    tm->tx = tx, tm->ty = ty;
+    tm->used = ++travel_map_uses;
+    (void) memcpy((genericptr_t) &tm->key, (genericptr_t) &key, sizeof key);
+    (void) memcpy((genericptr_t) tm->spots, (genericptr_t) spots,
+                  sizeof spots);
+    start_travel_search(&tm->search, tx, ty);
+    return &tm->search;
+}
+
 /*
  * Find a path from the destination (u.tx,u.ty) back to (u.ux,u.uy).
  * A shortest path is returned.  If guess is TRUE, consider various
@@ -934,14 +1289,10 @@ int mode;
             context.run = 8;
     }
     if (u.tx != u.ux || u.ty != u.uy) {
-        xchar travel[COLNO][ROWNO];
-        xchar travelstepx[2][COLNO * ROWNO];
-        xchar travelstepy[2][COLNO * ROWNO];
-        xchar tx, ty, ux, uy;
-        int n = 1;      /* max offset in travelsteps */
-        int set = 0;    /* two sets current and previous */
-        int radius = 1; /* search radius */
-        int i;
+        static struct travel_search search;
+        struct travel_search *ts;
+        xchar tx, ty, ux, uy, x, y;
+        boolean found;
 
         /* If guessing, first find an "obvious" goal location.  The obvious
          * goal is the position the player knows of, or might figure out
@@ -960,127 +1311,33 @@ int mode;
         }
 
     noguess:
-        (void) memset((genericptr_t) travel, 0, sizeof(travel));
-        travelstepx[0][0] = tx;
-        travelstepy[0][0] = ty;
-
-        while (n != 0) {
-            int nn = 0;
-
-            for (i = 0; i < n; i++) {
-                int dir;
-                int x = travelstepx[set][i];
-                int y = travelstepy[set][i];
-                static int ordered[] = { 0, 2, 4, 6, 1, 3, 5, 7 };
-                /* no diagonal movement for grid bugs */
-                int dirmax = NODIAG(u.umonnum) ? 4 : 8;
-                boolean alreadyrepeated = FALSE;
-
-                for (dir = 0; dir < dirmax; ++dir) {
-                    int nx = x + xdir[ordered[dir]];
-                    int ny = y + ydir[ordered[dir]];
-
-                    /*
-                     * When guessing and trying to travel as close as possible
-                     * to an unreachable target space, don't include spaces
-                     * that would never be picked as a guessed target in the
-                     * travel matrix describing hero-reachable spaces.
-                     * This stops travel from getting confused and moving
-                     * the hero back and forth in certain degenerate
-                     * configurations of sight-blocking obstacles, e.g.
-                     *
-                     *  T         1. Dig this out and carry enough to not be
-                     *   ####       able to squeeze through diagonal gaps.
-                     *   #--.---    Stand at @ and target travel at space T.
-                     *    @.....
-                     *    |.....
-                     *
-                     *  T         2. couldsee() marks spaces marked a and x
-                     *   ####       as eligible guess spaces to move the hero
-                     *   a--.---    towards.  Space a is closest to T, so it
-                     *    @xxxxx    gets chosen.  Travel system moves @ right
-                     *    |xxxxx    to travel to space a.
-                     *
-                     *  T         3. couldsee() marks spaces marked b, c and x
-                     *   ####       as eligible guess spaces to move the hero
-                     *   a--c---    towards.  Since findtravelpath() is called
-                     *    b@xxxx    repeatedly during travel, it doesn't
-                     *    |xxxxx    remember that it wanted to go to space a,
-                     *              so in comparing spaces b and c, b is
-                     *              chosen, since it seems like the closest
-                     *              eligible space to T. Travel system moves @
-                     *              left to go to space b.
-                     *
-                     *            4. Go to 2.
-                     *
-                     * By limiting the travel matrix here, space a in the
-                     * example above is never included in it, preventing
-                     * the cycle.
-                     */
-                    if (!isok(nx, ny)
-                        || ((mode == TRAVP_GUESS) && !couldsee(nx, ny)))
-                        continue;
-                    if ((!Passes_walls && !can_ooze(&youmonst)
-                         && closed_door(x, y)) || sobj_at(BOULDER, x, y)
-                        || test_move(x, y, nx-x, ny-y, TEST_TRAP)) {
-                        /* closed doors and boulders usually
-                         * cause a delay, so prefer another path */
-                        if (travel[x][y] > radius - 3) {
-                            if (!alreadyrepeated) {
-                                travelstepx[1 - set][nn] = x;
-                                travelstepy[1 - set][nn] = y;
-                                /* don't change travel matrix! */
-                                nn++;
-                                alreadyrepeated = TRUE;
-                            }
-                            continue;
-                        }
-                    }
-                    if (test_move(x, y, nx - x, ny - y, TEST_TRAV)
-                        && (levl[nx][ny].seenv
-                            || (!Blind && couldsee(nx, ny)))) {
-                        if (nx == ux && ny == uy) {
-                            if (mode == TRAVP_TRAVEL || mode == TRAVP_VALID) {
-                                u.dx = x - ux;
-                                u.dy = y - uy;
-                                if (mode == TRAVP_TRAVEL
-                                    && x == u.tx && y == u.ty) {
-                                    nomul(0);
-                                    /* reset run so domove run checks work */
-                                    context.run = 8;
-                                    iflags.travelcc.x = iflags.travelcc.y = -1;
-                                }
-                                return TRUE;
-                            }
-                        } else if (!travel[nx][ny]) {
-                            travelstepx[1 - set][nn] = nx;
-                            travelstepy[1 - set][nn] = ny;
-                            travel[nx][ny] = radius;
-                            nn++;
-                        }
-                    }
-                }
-            }
-
-#ifdef DEBUG
-            if (trav_debug) {
-                /* Use of warning glyph is arbitrary. It stands out. */
-                tmp_at(DISP_ALL, warning_to_glyph(1));
-                for (i = 0; i < nn; ++i) {
-                    tmp_at(travelstepx[1 - set][i], travelstepy[1 - set][i]);
-                }
-                delay_output();
-                if (flags.runmode == RUN_CRAWL) {
-                    delay_output();
-                    delay_output();
-                }
-                tmp_at(DISP_END, 0);
+        if (mode == TRAVP_TRAVEL && travel_map_usable()) {
+            /* searching outward from the destination reaches the same
+               spots in the same order wherever the hero is, so carry on
+               with an earlier search until it gets to the hero */
+            ts = find_travel_map(tx, ty);
+            if (ts->travel[ux][uy]) {
+                x = ux - xdir[ts->from[ux][uy]];
+                y = uy - ydir[ts->from[ux][uy]];
+                found = TRUE;
+            } else
+                found = continue_travel_search(ts, mode, ux, uy, TRUE,
+                                               &x, &y);
+        } else {
+            ts = &search;
+            start_travel_search(ts, tx, ty);
+            found = continue_travel_search(ts, mode, ux, uy, FALSE, &x, &y);
+        }
+        if (found) {
+            u.dx = x - ux;
+            u.dy = y - uy;
+            if (mode == TRAVP_TRAVEL && x == u.tx && y == u.ty) {
+                nomul(0);
+                /* reset run so domove run checks work */
+                context.run = 8;
+                iflags.travelcc.x = iflags.travelcc.y = -1;
             }
-#endif /* DEBUG */
-
-            n = nn;
-            set = 1 - set;
-            radius++;
+            return TRUE;
         }
 
         /* if guessing, find best location in travel matrix and go there */
@@ -1092,7 +1349,7 @@ int mode;
             d2 = dist2(ux, uy, tx, ty);
             for (tx = 1; tx < COLNO; ++tx)
                 for (ty = 0; ty < ROWNO; ++ty)
-                    if (travel[tx][ty]) {
+                    if (ts->travel[tx][ty]) {
                         nxtdist = distmin(ux, uy, tx, ty);
                         if (nxtdist == dist && couldsee(tx, ty)) {
                             nd2 = dist2(ux, uy, tx, ty);
@@ -1137,8 +1394,6 @@ int mode;
             ty = py;
             ux = u.ux;
             uy = u.uy;
-            set = 0;
-            n = radius = 1;
             mode = TRAVP_TRAVEL;
             goto noguess;
         }
@@ -67,6 +67,12 @@
         void            strbuf_reserve  (strbuf *, int)
         void            strbuf_empty    (strbuf *)
         void            strbuf_nl_to_crlf (strbuf_t *)
+        void            idmap_add       (idmap_t *, unsigned, anything *)
+        boolean         idmap_remove    (idmap_t *, unsigned, anything *)
+        anything *      idmap_next      (idmap_t *, unsigned, int *)
+        void            idmap_empty     (idmap_t *)
+        unsigned long   crc32c          (unsigned long, genericptr_t,
+                                         unsigned)
 =*/
 #ifdef LINT
 #define Static /* pacify lint */
@@ -76,6 +82,9 @@
 
 static boolean FDECL(pmatch_internal, (const char *, const char *,
                                        BOOLEAN_P, const char *));
+static int FDECL(idmap_home, (idmap_t *, unsigned));
+static void FDECL(idmap_grow, (idmap_t *));
+static void NDECL(crc32c_init);
 
 /* is 'c' a digit? */
 boolean
@@ -1186,4 +1195,246 @@ strbuf_t *strbuf;
     }
 }
 
+/*
+ * Simple open-addressed (linear probing) hash keyed by object or monster
+ * id.  The same id may be present more than once, paired with different
+ * values; callers walk every match with idmap_next() and decide which
+ * one they want.  Id 0 can't be stored since it marks empty slots.
+ */
+
+static int
+idmap_home(map, id)
+idmap_t *map;
+unsigned id;
+{
+    unsigned long h = ((unsigned long) id * 2654435761UL) & 0xffffffffUL;
+
+    return (int) ((h ^ (h >> 15)) & (unsigned long) (map->siz - 1));
+}
+
+/* double the slot count (or make the initial allocation) and rehash */
+static void
+idmap_grow(map)
+idmap_t *map;
+{
+    struct idmap_ent *oldent = map->ent;
+    int i, j, oldsiz = map->siz;
+
+    map->siz = oldsiz ? oldsiz * 2 : 256;
+    map->ent = (struct idmap_ent *) alloc(map->siz * sizeof *map->ent);
+    (void) memset((genericptr_t) map->ent, 0, map->siz * sizeof *map->ent);
+    for (i = 0; i < oldsiz; i++)
+        if (oldent[i].id) {
+            j = idmap_home(map, oldent[i].id);
+            while (map->ent[j].id)
+                j = (j + 1) & (map->siz - 1);
+            map->ent[j] = oldent[i];
+        }
+    if (oldent)
+        free((genericptr_t) oldent);
+}
+
+/* idmap_add() pairs val with id; adding an existing pair is a no-op */
+void
+idmap_add(map, id, val)
+idmap_t *map;
+unsigned id;
+anything *val;
+{
+    int i, mask;
+
+    if (!id)
+        return;
+    if (2 * (map->cnt + 1) > map->siz)
+        idmap_grow(map);
+    mask = map->siz - 1;
+    for (i = idmap_home(map, id); map->ent[i].id; i = (i + 1) & mask)
+        if (map->ent[i].id == id && map->ent[i].val.a_void == val->a_void)
+            return;
+    map->ent[i].id = id;
+    map->ent[i].val = *val;
+    map->cnt++;
+}
+
+/* idmap_remove() drops the pairing of id with val, if there is one */
+boolean
+idmap_remove(map, id, val)
+idmap_t *map;
+unsigned id;
+anything *val;
+{
+    int i, j, k, mask = map->siz - 1;
+
+    if (!id || !map->cnt)
+        return FALSE;
+    for (i = idmap_home(map, id); map->ent[i].id; i = (i + 1) & mask)
+        if (map->ent[i].id == id && map->ent[i].val.a_void == val->a_void)
+            break;
+    if (!map->ent[i].id)
+        return FALSE;
+    /* close the gap by shifting back any later entry of this probe run
+       whose home slot doesn't lie strictly between the gap and itself */
+    for (j = i;;) {
+        map->ent[i].id = 0;
+        do {
+            j = (j + 1) & mask;
+            if (!map->ent[j].id) {
+                map->cnt--;
+                return TRUE;
+            }
+            k = idmap_home(map, map->ent[j].id);
+        } while (i <= j ? (i < k && k <= j) : (i < k || k <= j));
+        map->ent[i] = map->ent[j];
+        i = j;
+    }
+}
+
+/* idmap_next() returns the next value paired with id, or Null when there
+   are no more; *cursor must be -1 before the first call */
+anything *
+idmap_next(map, id, cursor)
+idmap_t *map;
+unsigned id;
+int *cursor;
+{
+    int i, mask = map->siz - 1;
+
+    if (!id || !map->cnt)
+        return (anything *) 0;
+    i = (*cursor < 0) ? idmap_home(map, id) : ((*cursor + 1) & mask);
+    for (; map->ent[i].id; i = (i + 1) & mask)
+        if (map->ent[i].id == id) {
+            *cursor = i;
+            return &map->ent[i].val;
+        }
+    return (anything *) 0;
+}
+
+/* idmap_empty() frees allocated memory and sets map to initial state */
+void
+idmap_empty(map)
+idmap_t *map;
+{
+    if (map->ent)
+        free((genericptr_t) map->ent);
+    map->ent = (struct idmap_ent *) 0;
+    map->cnt = map->siz = 0;
+}
+
+/*
+ * CRC-32C (the Castagnoli polynomial, reflected), as used to check the
+ * chunks of save, level, and bones files.  x86-64 processors with SSE4.2
+ * and ARMv8 ones with the CRC extension have an instruction for it;
+ * elsewhere it's computed four bytes at a time with tables.
+ */
+#define CRC32C_POLY 0x82f63b78UL
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(NO_HW_CRC32C)
+#define HW_CRC32C
+static unsigned long FDECL(crc32c_hw, (unsigned long, const unsigned char *,
+                                       unsigned))
+                                       __attribute__((target("sse4.2")));
+
+static unsigned long
+crc32c_hw(crc, p, len)
+unsigned long crc;
+const unsigned char *p;
+unsigned len;
+{
+    unsigned long long c = crc, w;
+
+    for (; len >= 8; p += 8, len -= 8) {
+        (void) memcpy((genericptr_t) &w, (genericptr_t) p, 8);
+        c = __builtin_ia32_crc32di(c, w);
+    }
+    for (; len; p++, len--)
+        c = __builtin_ia32_crc32qi((unsigned) c, *p);
+    return (unsigned long) c;
+}
+#define crc32c_hw_ok() __builtin_cpu_supports("sse4.2")
+#endif
+
+#if defined(__GNUC__) && defined(__aarch64__) && defined(__ARM_FEATURE_CRC32) \
+    && !defined(NO_HW_CRC32C)
+#include <arm_acle.h>
+#define HW_CRC32C
+
+static unsigned long
+crc32c_hw(crc, p, len)
+unsigned long crc;
+const unsigned char *p;
+unsigned len;
+{
+    unsigned long long w;
+    unsigned c = (unsigned) crc;
+
+    for (; len >= 8; p += 8, len -= 8) {
+        (void) memcpy((genericptr_t) &w, (genericptr_t) p, 8);
+        c = __crc32cd(c, w);
+    }
+    for (; len; p++, len--)
+        c = __crc32cb(c, *p);
+    return (unsigned long) c;
+}
+#define crc32c_hw_ok() 1 /* the compiler was told the processor has it */
+#endif
+
+static unsigned long crc32c_table[4][256];
+static int crc32c_how = 0; /* 0: not yet decided, 1: tables, 2: hardware */
+
+static void
+crc32c_init()
+{
+    unsigned long c;
+    int i, j;
+
+#ifdef HW_CRC32C
+    if (crc32c_hw_ok()) {
+        crc32c_how = 2;
+        return;
+    }
+#endif
+    for (i = 0; i < 256; i++) {
+        c = (unsigned long) i;
+        for (j = 0; j < 8; j++)
+            c = (c & 1) ? (c >> 1) ^ CRC32C_POLY : (c >> 1);
+        crc32c_table[0][i] = c;
+    }
+    for (i = 0; i < 256; i++)
+        for (c = crc32c_table[0][i], j = 1; j < 4; j++) {
+            c = (c >> 8) ^ crc32c_table[0][c & 0xff];
+            crc32c_table[j][i] = c;
+        }
+    crc32c_how = 1;
+}
+
+/* crc32c() extends crc, the CRC-32C of what came before (0 to start),
+   over len more bytes at buf */
+unsigned long
+crc32c(crc, buf, len)
+unsigned long crc;
+genericptr_t buf;
+unsigned len;
+{
+    const unsigned char *p = (const unsigned char *) buf;
+    unsigned long c;
+
+    if (!crc32c_how)
+        crc32c_init();
+    c = ~crc & 0xffffffffUL;
+#ifdef HW_CRC32C
+    if (crc32c_how == 2)
+        return ~crc32c_hw(c, p, len) & 0xffffffffUL;
+#endif
+    for (; len >= 4; p += 4, len -= 4) {
+        c ^= (unsigned long) p[0] | ((unsigned long) p[1] << 8)
+             | ((unsigned long) p[2] << 16) | ((unsigned long) p[3] << 24);
+        c = crc32c_table[3][c & 0xff] ^ crc32c_table[2][(c >> 8) & 0xff]
+            ^ crc32c_table[1][(c >> 16) & 0xff] ^ crc32c_table[0][c >> 24];
+    }
+    for (; len; p++, len--)
+        c = (c >> 8) ^ crc32c_table[0][(c ^ *p) & 0xff];
+    return ~c & 0xffffffffUL;
+}
+
 /*hacklib.c*/
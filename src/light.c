@@ -8,8 +8,8 @@
 /*
  * Mobile light sources.
  *
- * This implementation minimizes memory at the expense of extra
- * recalculations.
+ * Each light source remembers the area it lit last time, so that vision
+ * recalculations don't have to redo its line of sight from scratch.
  *
  * Light sources are "things" that have a physical position and range.
  * They have a type, which gives us information about them.  Currently
@@ -25,12 +25,13 @@
  * The major working function is do_light_sources(). It is called
  * when the vision system is recreating its "could see" array.  Here
  * we add a flag (TEMP_LIT) to the array for all locations that are lit
- * via a light source.  The bad part of this is that we have to
- * re-calculate the LOS of each light source every time the vision
- * system runs.  Even if the light sources and any topology (vision blocking
- * positions) have not changed.  The good part is that no extra memory
- * is used, plus we don't have to figure out how far the sources have moved,
- * or if the topology has changed.
+ * via a light source.  Working out which locations a source can reach
+ * takes a clear_path() call for every spot in its circle, so each
+ * source keeps the answer in a small bitmask (struct ls_lit) and only
+ * redoes it when the source moves, its range changes, or the vision
+ * system tells us (light_block_changed()) that a spot within range has
+ * started or stopped blocking light.  Sources at the hero's position
+ * use the vision system's own "could see" bits instead and aren't cached.
  *
  * The structure of the save/restore mechanism is amazingly similar to
  * the timer save/restore.  This is because they both have the same
@@ -41,11 +42,25 @@
 /* flags */
 #define LSF_SHOW 0x1        /* display the light source */
 #define LSF_NEEDS_FIXUP 0x2 /* need oid fixup */
+#define LSF_ON_MAP 0x4      /* was on the map at the last vision pass */
+
+/*
+ * Spots lit by a source at <x,y> with the given range: bit (dx + range)
+ * of row[dy + range] is set when <x+dx,y+dy> is lit.  A range of 0 means
+ * the mask is stale.
+ */
+struct ls_lit {
+    xchar x, y;
+    short range;
+    unsigned long row[2 * MAX_RADIUS + 1];
+};
 
 static light_source *light_base = 0;
 
 STATIC_DCL void FDECL(write_ls, (int, light_source *));
 STATIC_DCL int FDECL(maybe_write_ls, (int, int, BOOLEAN_P));
+STATIC_DCL void FDECL(set_ls_lit, (light_source *));
+STATIC_DCL void FDECL(free_ls, (light_source *));
 
 /* imported from vision.c, for small circles */
 extern char circle_data[];
@@ -74,6 +89,7 @@ anything *id;
     ls->type = type;
     ls->id = *id;
     ls->flags = 0;
+    ls->lit = (struct ls_lit *) 0;
     light_base = ls;
 
     vision_full_recalc = 1; /* make the source show up */
@@ -117,7 +133,7 @@ anything *id;
             else
                 light_base = curr->next;
 
-            free((genericptr_t) curr);
+            free_ls(curr);
             vision_full_recalc = 1;
             return;
         }
@@ -135,23 +151,22 @@ char **cs_rows;
     char *limits;
     short at_hero_range = 0;
     light_source *ls;
+    unsigned long bits, *litrow;
     char *row;
 
     for (ls = light_base; ls; ls = ls->next) {
-        ls->flags &= ~LSF_SHOW;
+        ls->flags &= ~(LSF_SHOW | LSF_ON_MAP);
 
         /*
-         * Check for moved light sources.  It may be possible to
-         * save some effort if an object has not moved, but not in
-         * the current setup -- we need to recalculate for every
-         * vision recalc.
+         * Check for moved light sources.  A source which has moved
+         * gets its lit area recalculated below.
          */
         if (ls->type == LS_OBJECT) {
             if (get_obj_location(ls->id.a_obj, &ls->x, &ls->y, 0))
-                ls->flags |= LSF_SHOW;
+                ls->flags |= LSF_SHOW | LSF_ON_MAP;
         } else if (ls->type == LS_MONSTER) {
             if (get_mon_location(ls->id.a_monst, &ls->x, &ls->y, 0))
-                ls->flags |= LSF_SHOW;
+                ls->flags |= LSF_SHOW | LSF_ON_MAP;
         }
 
         /* minor optimization: don't bother with duplicate light sources */
@@ -163,19 +178,27 @@ char **cs_rows;
                 at_hero_range = ls->range;
         }
 
-        if (ls->flags & LSF_SHOW) {
+        if (!(ls->flags & LSF_SHOW))
+            continue;
+
+        if ((max_y = (ls->y + ls->range)) >= ROWNO)
+            max_y = ROWNO - 1;
+        if ((y = (ls->y - ls->range)) < 0)
+            y = 0;
+
+        if (ls->x == u.ux && ls->y == u.uy) {
             /*
-             * Walk the points in the circle and see if they are
-             * visible from the center.  If so, mark'em.
-             *
-             * Kevin's tests indicated that doing this brute-force
-             * method is faster for radius <= 3 (or so).
+             * If the light source is located at the hero, then
+             * we can use the COULD_SEE bits already calculated
+             * by the vision system.  More importantly than
+             * this optimization, is that it allows the vision
+             * system to correct problems with clear_path().
+             * The function clear_path() is a simple LOS
+             * path checker that doesn't go out of its way
+             * make things look "correct".  The vision system
+             * does this.
              */
             limits = circle_ptr(ls->range);
-            if ((max_y = (ls->y + ls->range)) >= ROWNO)
-                max_y = ROWNO - 1;
-            if ((y = (ls->y - ls->range)) < 0)
-                y = 0;
             for (; y <= max_y; y++) {
                 row = cs_rows[y];
                 offset = limits[abs(y - ls->y)];
@@ -183,31 +206,139 @@ char **cs_rows;
                     min_x = 0;
                 if ((max_x = (ls->x + offset)) >= COLNO)
                     max_x = COLNO - 1;
-
-                if (ls->x == u.ux && ls->y == u.uy) {
-                    /*
-                     * If the light source is located at the hero, then
-                     * we can use the COULD_SEE bits already calculated
-                     * by the vision system.  More importantly than
-                     * this optimization, is that it allows the vision
-                     * system to correct problems with clear_path().
-                     * The function clear_path() is a simple LOS
-                     * path checker that doesn't go out of its way
-                     * make things look "correct".  The vision system
-                     * does this.
-                     */
-                    for (x = min_x; x <= max_x; x++)
-                        if (row[x] & COULD_SEE)
-                            row[x] |= TEMP_LIT;
-                } else {
-                    for (x = min_x; x <= max_x; x++)
-                        if ((ls->x == x && ls->y == y)
-                            || clear_path((int) ls->x, (int) ls->y, x, y))
-                            row[x] |= TEMP_LIT;
-                }
+                for (x = min_x; x <= max_x; x++)
+                    if (row[x] & COULD_SEE)
+                        row[x] |= TEMP_LIT;
             }
+        } else {
+            if (!ls->lit || ls->lit->range != ls->range
+                || ls->lit->x != ls->x || ls->lit->y != ls->y)
+                set_ls_lit(ls);
+            litrow = &ls->lit->row[y - ls->y + ls->range];
+            for (; y <= max_y; y++, litrow++) {
+                row = cs_rows[y];
+                for (bits = *litrow, x = ls->x - ls->range; bits;
+                     bits >>= 1, x++)
+                    if (bits & 1UL)
+                        row[x] |= TEMP_LIT;
+            }
+        }
+    }
+}
+
+/*
+ * Work out which spots within range of a light source are lit, using
+ * the brute-force method of walking the points in the circle and seeing
+ * if they are visible from the center.  Kevin's tests indicated that
+ * this is faster for radius <= 3 (or so).
+ */
+STATIC_OVL void
+set_ls_lit(ls)
+light_source *ls;
+{
+    int x, y, min_x, max_x, max_y, offset;
+    char *limits;
+    unsigned long bits;
+    struct ls_lit *lit;
+
+    if (!ls->lit)
+        ls->lit = (struct ls_lit *) alloc(sizeof (struct ls_lit));
+    lit = ls->lit;
+    lit->x = ls->x;
+    lit->y = ls->y;
+    lit->range = ls->range;
+    (void) memset((genericptr_t) lit->row, 0, sizeof lit->row);
+
+    limits = circle_ptr(ls->range);
+    if ((max_y = (ls->y + ls->range)) >= ROWNO)
+        max_y = ROWNO - 1;
+    if ((y = (ls->y - ls->range)) < 0)
+        y = 0;
+    for (; y <= max_y; y++) {
+        offset = limits[abs(y - ls->y)];
+        if ((min_x = (ls->x - offset)) < 0)
+            min_x = 0;
+        if ((max_x = (ls->x + offset)) >= COLNO)
+            max_x = COLNO - 1;
+
+        bits = 0UL;
+        for (x = min_x; x <= max_x; x++)
+            if ((ls->x == x && ls->y == y)
+                || clear_path((int) ls->x, (int) ls->y, x, y))
+                bits |= 1UL << (x - ls->x + ls->range);
+        lit->row[y - ls->y + ls->range] = bits;
+    }
+}
+
+/*
+ * The spot <x,y> has started or stopped blocking light; called by the
+ * vision system.  Any cached lit area that might be affected is stale,
+ * and what it lights may have changed even if the hero can't see <x,y>
+ * itself (a door closing between a lamp and the far side of a room), so
+ * vision has to be redone.
+ */
+void
+light_block_changed(x, y)
+int x, y;
+{
+    light_source *ls;
+    struct ls_lit *lit;
+
+    for (ls = light_base; ls; ls = ls->next)
+        if ((lit = ls->lit) != 0 && lit->range
+            && abs(x - lit->x) <= lit->range
+            && abs(y - lit->y) <= lit->range) {
+            lit->range = 0;
+            vision_full_recalc = 1;
         }
+}
+
+/* forget all cached lit areas; used when the vision system starts over */
+void
+flush_light_cache()
+{
+    light_source *ls;
+
+    for (ls = light_base; ls; ls = ls->next)
+        if (ls->lit)
+            ls->lit->range = 0;
+}
+
+/*
+ * Return true if some light source has moved, or has come onto or left
+ * the map, since the last vision pass.  Monster movement uses this to
+ * decide whether vision needs to be redone.
+ */
+boolean
+light_sources_moved()
+{
+    light_source *ls;
+    xchar x, y;
+    boolean on_map;
+
+    for (ls = light_base; ls; ls = ls->next) {
+        x = ls->x, y = ls->y;
+        if (ls->type == LS_OBJECT)
+            on_map = get_obj_location(ls->id.a_obj, &x, &y, 0);
+        else if (ls->type == LS_MONSTER)
+            on_map = get_mon_location(ls->id.a_monst, &x, &y, 0);
+        else
+            on_map = FALSE;
+        if (on_map != ((ls->flags & LSF_ON_MAP) != 0)
+            || (on_map && (x != ls->x || y != ls->y)))
+            return TRUE;
     }
+    return FALSE;
+}
+
+/* release a light source and its cached lit area */
+STATIC_OVL void
+free_ls(ls)
+light_source *ls;
+{
+    if (ls->lit)
+        free((genericptr_t) ls->lit);
+    free((genericptr_t) ls);
 }
 
 /* (mon->mx == 0) implies migrating */
@@ -218,23 +349,24 @@ find_mid(nid, fmflags)
 unsigned nid;
 unsigned fmflags;
 {
-    struct monst *mtmp;
+    static const unsigned chainflag[] = { 0, FM_FMON, FM_MIGRATE, FM_MYDOGS };
+    struct monst *mtmp, *best = (struct monst *) 0;
+    anything *val;
+    int cursor = -1;
 
     if (!nid)
         return &youmonst;
-    if (fmflags & FM_FMON)
-        for (mtmp = fmon; mtmp; mtmp = mtmp->nmon)
-            if (!DEADMONSTER(mtmp) && mtmp->m_id == nid)
-                return mtmp;
-    if (fmflags & FM_MIGRATE)
-        for (mtmp = migrating_mons; mtmp; mtmp = mtmp->nmon)
-            if (mtmp->m_id == nid)
-                return mtmp;
-    if (fmflags & FM_MYDOGS)
-        for (mtmp = mydogs; mtmp; mtmp = mtmp->nmon)
-            if (mtmp->m_id == nid)
-                return mtmp;
-    return (struct monst *) 0;
+    /* mon_id_map may hold the same id more than once; prefer fmon,
+       then migrating_mons, then mydogs, the order of the old searches */
+    while ((val = idmap_next(&mon_id_map, nid, &cursor)) != 0) {
+        mtmp = val->a_monst;
+        if (!(fmflags & chainflag[mtmp->mchain])
+            || (mtmp->mchain == MCHAIN_FMON && DEADMONSTER(mtmp)))
+            continue;
+        if (!best || mtmp->mchain < best->mchain)
+            best = mtmp;
+    }
+    return best;
 }
 
 /* Save all light sources of the given range. */
@@ -276,7 +408,7 @@ int fd, mode, range;
             /* if global and not doing local, or vice versa, remove it */
             if (is_global ^ (range == RANGE_LEVEL)) {
                 *prev = curr->next;
-                free((genericptr_t) curr);
+                free_ls(curr);
             } else {
                 prev = &(*prev)->next;
             }
@@ -301,6 +433,7 @@ int fd;
     while (count-- > 0) {
         ls = (light_source *) alloc(sizeof(light_source));
         mread(fd, (genericptr_t) ls, sizeof(light_source));
+        ls->lit = (struct ls_lit *) 0;
         ls->next = light_base;
         light_base = ls;
     }
@@ -320,6 +453,8 @@ long *count, *size;
     for (ls = light_base; ls; ls = ls->next) {
         ++*count;
         *size += (long) sizeof *ls;
+        if (ls->lit)
+            *size += (long) sizeof *ls->lit;
     }
 }
 
@@ -562,6 +697,7 @@ struct obj *src, *dest;
              */
             new_ls = (light_source *) alloc(sizeof(light_source));
             *new_ls = *ls;
+            new_ls->lit = (struct ls_lit *) 0;
             if (Is_candle(src)) {
                 /* split candles may emit less light than original group */
                 ls->range = candle_light_range(src);
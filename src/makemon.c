@@ -15,7 +15,8 @@
      && (mptr->msound == MS_LEADER || mptr->msound == MS_NEMESIS))
 
 STATIC_DCL boolean FDECL(uncommon, (int));
-STATIC_DCL int FDECL(align_shift, (struct permonst *));
+STATIC_DCL int NDECL(level_align);
+STATIC_DCL int FDECL(align_shift, (struct permonst *, int));
 STATIC_DCL boolean FDECL(mk_gen_ok, (int, int, int));
 STATIC_DCL boolean FDECL(wrong_elem_type, (struct permonst *));
 STATIC_DCL void FDECL(m_initgrp, (struct monst *, int, int, int));
@@ -817,6 +818,7 @@ xchar x, y; /* clone's preferred location or 0 (near mon) */
     m2->m_id = context.ident++;
     if (!m2->m_id)
         m2->m_id = context.ident++; /* ident overflowed */
+    index_mon_id(m2, MCHAIN_FMON);
     m2->mx = mm.x;
     m2->my = mm.y;
 
@@ -1177,6 +1179,7 @@ int mmflags;
     mtmp->m_id = context.ident++;
     if (!mtmp->m_id)
         mtmp->m_id = context.ident++; /* ident overflowed */
+    index_mon_id(mtmp, MCHAIN_FMON);
     set_mon_data(mtmp, ptr, 0);
     if (ptr->msound == MS_LEADER && quest_info(MS_LEADER) == mndx)
         quest_status.leader_m_id = mtmp->m_id;
@@ -1448,24 +1451,33 @@ int mndx;
         return (boolean) ((mons[mndx].geno & G_HELL) != 0);
 }
 
+/* alignment of the current level or dungeon (AM_xxx) */
+STATIC_OVL int
+level_align()
+{
+    static NEARDATA long oldmoves = 0L; /* != 1, starting value of moves */
+    static NEARDATA s_level *lev;
+
+    if (oldmoves != moves) {
+        lev = Is_special(&u.uz);
+        oldmoves = moves;
+    }
+    return (lev) ? lev->flags.align : dungeons[u.uz.dnum].flags.align;
+}
+
 /*
  *      shift the probability of a monster's generation by
  *      comparing the dungeon alignment and monster alignment.
  *      return an integer in the range of 0-5.
  */
 STATIC_OVL int
-align_shift(ptr)
+align_shift(ptr, levalign)
 register struct permonst *ptr;
+int levalign; /* from level_align() */
 {
-    static NEARDATA long oldmoves = 0L; /* != 1, starting value of moves */
-    static NEARDATA s_level *lev;
     register int alshift;
 
-    if (oldmoves != moves) {
-        lev = Is_special(&u.uz);
-        oldmoves = moves;
-    }
-    switch ((lev) ? lev->flags.align : dungeons[u.uz.dnum].flags.align) {
+    switch (levalign) {
     default: /* just in case */
     case AM_NONE:
         alshift = 0;
@@ -1483,89 +1495,187 @@ register struct permonst *ptr;
     return alshift;
 }
 
-static NEARDATA struct {
-    int choice_count;
-    char mchoices[SPECIAL_PM]; /* value range is 0..127 */
-} rndmonst_state = { -1, { 0 } };
+/*
+ * rndmonst() picks from a table of eligible monsters weighted by
+ * frequency and alignment shift.  The table depends only on the
+ * selection criteria below (plus which species are gone), so a few
+ * of them are kept around for reuse when the hero returns to a level
+ * or experience level with the same criteria.
+ *
+ * Each table is a Walker alias table:  with N candidates and total
+ * weight W, every candidate owns a column of height W holding N times
+ * its weight, split between itself (below 'cut') and one 'alias'.
+ * A single rn2(N * W) picks both the column and the height within it,
+ * so a draw costs the same one random number the old cumulative walk
+ * used and gives each monster exactly its old probability.
+ */
+struct rndmonst_key {
+    int minmlev, maxmlev; /* difficulty range */
+    int levalign;         /* level_align() */
+    boolean inhell;       /* Inhell: no G_NOHELL, lawfuls uncommon */
+    boolean upper;        /* Rogue level: upper case letters only */
+    xchar elemlevel;      /* elemental plane's ledger number, or 0;
+                             wrong_elem_type() differs per plane */
+};
+
+#define RNDMONST_TABLES 8 /* number of cached selection tables */
+
+static NEARDATA struct rndmonst_table {
+    struct rndmonst_key key;
+    long lastused;           /* for picking a table to recycle */
+    int choice_count;        /* total weight; 0 if no monster eligible */
+    int ncand;               /* number of candidates */
+    short mndx[SPECIAL_PM];  /* candidate monsters */
+    short alias[SPECIAL_PM]; /* other owner of each column */
+    int cut[SPECIAL_PM];     /* height where the alias takes over */
+} rndmonst_tables[RNDMONST_TABLES];
+static NEARDATA int rndmonst_ntables = 0;
+static NEARDATA long rndmonst_clock = 0L;
+/* table in use until reset_rndmonst() says the criteria have changed */
+static NEARDATA struct rndmonst_table *rndmonst_cur = 0;
+
+STATIC_DCL boolean FDECL(same_rndmonst_key, (struct rndmonst_key *,
+                                              struct rndmonst_key *));
+STATIC_DCL void FDECL(build_rndmonst_table, (struct rndmonst_table *));
+
+STATIC_OVL boolean
+same_rndmonst_key(k1, k2)
+struct rndmonst_key *k1, *k2;
+{
+    return (boolean) (k1->minmlev == k2->minmlev && k1->maxmlev == k2->maxmlev
+                      && k1->levalign == k2->levalign
+                      && k1->inhell == k2->inhell && k1->upper == k2->upper
+                      && k1->elemlevel == k2->elemlevel);
+}
+
+/* fill in a selection table for the criteria in tbl->key */
+STATIC_OVL void
+build_rndmonst_table(tbl)
+struct rndmonst_table *tbl;
+{
+    register struct permonst *ptr;
+    register int mndx, ct;
+    int i, nsmall, nlarge, sm, lg, total;
+    int weight[SPECIAL_PM];
+    short small[SPECIAL_PM], large[SPECIAL_PM];
+
+    tbl->choice_count = tbl->ncand = 0;
+    for (mndx = LOW_PM; mndx < SPECIAL_PM; mndx++) {
+        ptr = &mons[mndx];
+        if (tooweak(mndx, tbl->key.minmlev)
+            || toostrong(mndx, tbl->key.maxmlev))
+            continue;
+        if (tbl->key.upper
+            && !isupper((uchar) def_monsyms[(int) ptr->mlet].sym))
+            continue;
+        if (tbl->key.elemlevel && wrong_elem_type(ptr))
+            continue;
+        if (uncommon(mndx))
+            continue;
+        if (tbl->key.inhell && (ptr->geno & G_NOHELL))
+            continue;
+        ct = (int) (ptr->geno & G_FREQ) + align_shift(ptr, tbl->key.levalign);
+        if (ct < 0 || ct > 127)
+            panic("rndmonst: bad count [#%d: %d]", mndx, ct);
+        if (!ct)
+            continue;
+        tbl->choice_count += ct;
+        tbl->mndx[tbl->ncand] = (short) mndx;
+        weight[tbl->ncand++] = ct;
+    }
+    if (!tbl->ncand)
+        return;
+
+    /* scale weights by N so that each column holds exactly W */
+    total = tbl->choice_count;
+    nsmall = nlarge = 0;
+    for (i = 0; i < tbl->ncand; i++) {
+        weight[i] *= tbl->ncand;
+        tbl->alias[i] = (short) i;
+        tbl->cut[i] = total;
+        if (weight[i] < total)
+            small[nsmall++] = (short) i;
+        else
+            large[nlarge++] = (short) i;
+    }
+    while (nsmall > 0 && nlarge > 0) {
+        sm = small[--nsmall];
+        lg = large[--nlarge];
+        tbl->cut[sm] = weight[sm];
+        tbl->alias[sm] = (short) lg;
+        weight[lg] -= total - weight[sm];
+        if (weight[lg] < total)
+            small[nsmall++] = (short) lg;
+        else
+            large[nlarge++] = (short) lg;
+    }
+    /* leftovers on either list fill their own column exactly */
+}
 
 /* select a random monster type */
 struct permonst *
 rndmonst()
 {
     register struct permonst *ptr;
+    register struct rndmonst_table *tbl;
     register int mndx, ct;
 
     if (u.uz.dnum == quest_dnum && rn2(7) && (ptr = qt_montype()) != 0)
         return ptr;
 
-    if (rndmonst_state.choice_count < 0) { /* need to recalculate */
-        int zlevel, minmlev, maxmlev;
-        boolean elemlevel;
-        boolean upper;
+    if (!rndmonst_cur) { /* need to recalculate */
+        struct rndmonst_key key;
+        int zlevel, i;
 
-        rndmonst_state.choice_count = 0;
-        /* look for first common monster */
-        for (mndx = LOW_PM; mndx < SPECIAL_PM; mndx++) {
-            if (!uncommon(mndx))
-                break;
-            rndmonst_state.mchoices[mndx] = 0;
-        }
-        if (mndx == SPECIAL_PM) {
-            /* evidently they've all been exterminated */
-            debugpline0("rndmonst: no common mons!");
-            return (struct permonst *) 0;
-        } /* else `mndx' now ready for use below */
         zlevel = level_difficulty();
         /* determine the level of the weakest monster to make. */
-        minmlev = zlevel / 6;
+        key.minmlev = zlevel / 6;
         /* determine the level of the strongest monster to make. */
-        maxmlev = (zlevel + u.ulevel) / 2;
-        upper = Is_rogue_level(&u.uz);
-        elemlevel = In_endgame(&u.uz) && !Is_astralevel(&u.uz);
-
-        /*
-         * Find out how many monsters exist in the range we have selected.
-         */
-        for ( ; mndx < SPECIAL_PM; mndx++) { /* (`mndx' initialized above) */
-            ptr = &mons[mndx];
-            rndmonst_state.mchoices[mndx] = 0;
-            if (tooweak(mndx, minmlev) || toostrong(mndx, maxmlev))
-                continue;
-            if (upper && !isupper((uchar) def_monsyms[(int) ptr->mlet].sym))
-                continue;
-            if (elemlevel && wrong_elem_type(ptr))
-                continue;
-            if (uncommon(mndx))
-                continue;
-            if (Inhell && (ptr->geno & G_NOHELL))
-                continue;
-            ct = (int) (ptr->geno & G_FREQ) + align_shift(ptr);
-            if (ct < 0 || ct > 127)
-                panic("rndmonst: bad count [#%d: %d]", mndx, ct);
-            rndmonst_state.choice_count += ct;
-            rndmonst_state.mchoices[mndx] = (char) ct;
+        key.maxmlev = (zlevel + u.ulevel) / 2;
+        key.levalign = level_align();
+        key.inhell = Inhell ? TRUE : FALSE;
+        key.upper = Is_rogue_level(&u.uz) ? TRUE : FALSE;
+        key.elemlevel = (In_endgame(&u.uz) && !Is_astralevel(&u.uz))
+                            ? ledger_no(&u.uz) : 0;
+
+        for (i = 0; i < rndmonst_ntables; i++)
+            if (same_rndmonst_key(&rndmonst_tables[i].key, &key))
+                break;
+        if (i == rndmonst_ntables) {
+            if (rndmonst_ntables < RNDMONST_TABLES) {
+                i = rndmonst_ntables++;
+            } else { /* recycle the least recently used one */
+                int j;
+
+                for (i = 0, j = 1; j < RNDMONST_TABLES; j++)
+                    if (rndmonst_tables[j].lastused
+                        < rndmonst_tables[i].lastused)
+                        i = j;
+            }
+            rndmonst_tables[i].key = key;
+            build_rndmonst_table(&rndmonst_tables[i]);
         }
-        /*
-         *      Possible modification:  if choice_count is "too low",
-         *      expand minmlev..maxmlev range and try again.
-         */
-    } /* choice_count+mchoices[] recalc */
+        rndmonst_cur = &rndmonst_tables[i];
+        rndmonst_cur->lastused = ++rndmonst_clock;
+    }
+    tbl = rndmonst_cur;
 
-    if (rndmonst_state.choice_count <= 0) {
+    if (tbl->choice_count <= 0) {
         /* maybe no common mons left, or all are too weak or too strong */
-        debugpline1("rndmonst: choice_count=%d", rndmonst_state.choice_count);
+        debugpline1("rndmonst: choice_count=%d", tbl->choice_count);
         return (struct permonst *) 0;
     }
 
     /*
      *  Now, select a monster at random.
      */
-    ct = rnd(rndmonst_state.choice_count);
-    for (mndx = LOW_PM; mndx < SPECIAL_PM; mndx++)
-        if ((ct -= (int) rndmonst_state.mchoices[mndx]) <= 0)
-            break;
+    ct = rn2(tbl->ncand * tbl->choice_count);
+    mndx = ct / tbl->choice_count;
+    if (ct % tbl->choice_count >= tbl->cut[mndx])
+        mndx = tbl->alias[mndx];
+    mndx = tbl->mndx[mndx];
 
-    if (mndx == SPECIAL_PM || uncommon(mndx)) { /* shouldn't happen */
+    if (uncommon(mndx)) { /* shouldn't happen */
         impossible("rndmonst: bad `mndx' [#%d]", mndx);
         return (struct permonst *) 0;
     }
@@ -1580,10 +1690,18 @@ int mndx; /* particular species that can no longer be created */
 {
     /* cached selection info is out of date */
     if (mndx == NON_PM) {
-        rndmonst_state.choice_count = -1; /* full recalc needed */
+        rndmonst_cur = 0; /* look up or build a table for new criteria */
     } else if (mndx < SPECIAL_PM) {
-        rndmonst_state.choice_count -= rndmonst_state.mchoices[mndx];
-        rndmonst_state.mchoices[mndx] = 0;
+        /* every cached table might include this species; keep using the
+           current criteria but rebuild it without the one that's gone */
+        rndmonst_ntables = 0;
+        if (rndmonst_cur) {
+            if (rndmonst_cur != &rndmonst_tables[0])
+                rndmonst_tables[0] = *rndmonst_cur;
+            rndmonst_cur = &rndmonst_tables[0];
+            rndmonst_ntables = 1;
+            build_rndmonst_table(rndmonst_cur);
+        }
     } /* note: safe to ignore extinction of unique monsters */
 }
 
@@ -596,6 +596,8 @@ clear_level_structures()
              */
             level.objects[x][y] = (struct obj *) 0;
             level.monsters[x][y] = (struct monst *) 0;
+            level.traps[x][y] = (struct trap *) 0;
+            level.engravings[x][y] = (struct engr *) 0;
         }
     }
     level.objlist = (struct obj *) 0;
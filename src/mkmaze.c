@@ -1704,8 +1704,7 @@ boolean ini;
 
             case CONS_TRAP: {
                 struct trap *btrap = (struct trap *) cons->list;
-                btrap->tx = cons->x;
-                btrap->ty = cons->y;
+                relocate_trap(btrap, cons->x, cons->y);
                 break;
             }
 
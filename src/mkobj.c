@@ -422,6 +422,7 @@ long num;
     otmp->o_id = context.ident++;
     if (!otmp->o_id)
         otmp->o_id = context.ident++; /* ident overflowed */
+    index_obj_id(otmp);
     otmp->timed = 0;                  /* not timed, yet */
     otmp->lamplit = 0;                /* ditto */
     otmp->owornmask = 0L;             /* new object isn't worn */
@@ -629,6 +630,7 @@ register struct obj *otmp;
     dummy->o_id = context.ident++;
     if (!dummy->o_id)
         dummy->o_id = context.ident++; /* ident overflowed */
+    index_obj_id(dummy);
     dummy->timed = 0;
     copy_oextra(dummy, otmp);
     if (has_omid(dummy))
@@ -748,6 +750,7 @@ boolean artif;
     otmp->o_id = context.ident++;
     if (!otmp->o_id)
         otmp->o_id = context.ident++; /* ident overflowed */
+    index_obj_id(otmp);
     otmp->quan = 1L;
     otmp->oclass = let;
     otmp->otyp = otyp;
@@ -2107,9 +2110,18 @@ struct obj *obj;
 
     if (obj->oextra)
         dealloc_oextra(obj);
+    (void) idmap_remove(&obj_id_map, obj->o_id, obj_to_any(obj));
     free((genericptr_t) obj);
 }
 
+/* make a newly allocated or renumbered object findable by find_oid() */
+void
+index_obj_id(obj)
+struct obj *obj;
+{
+    idmap_add(&obj_id_map, obj->o_id, obj_to_any(obj));
+}
+
 /* create an object from a horn of plenty; mirrors bagotricks(makemon.c) */
 int
 hornoplenty(horn, tipping)
@@ -28,6 +28,20 @@ STATIC_DCL struct permonst *FDECL(accept_newcham_form, (int));
 STATIC_DCL struct obj *FDECL(make_corpse, (struct monst *, unsigned));
 STATIC_DCL void FDECL(m_detach, (struct monst *, struct permonst *));
 STATIC_DCL void FDECL(lifesaved_monster, (struct monst *));
+STATIC_DCL void FDECL(mready_add, (struct monst *));
+
+/*
+ * Monsters which might still get to move this turn, in fmon order:
+ * those with at least NORMAL_SPEED movement left, plus vault guards.
+ * Lets movemon() avoid walking all of fmon on each of its passes.
+ * Entries are re-checked when reached, so monsters which die, leave
+ * fmon or lose movement need no attention; anything which would
+ * add to the set or reorder it (a monster joining fmon) marks the
+ * array stale and the next pass walks fmon to rebuild it.
+ */
+static struct monst **mready = 0;
+static int mready_cnt = 0, mready_siz = 0;
+static boolean mready_stale = TRUE;
 
 #define LEVEL_SPECIFIC_NOCORPSE(mdat) \
     (Is_rogue_level(&u.uz)            \
@@ -626,6 +640,40 @@ struct monst *mon;
     return mmove;
 }
 
+/* reallocate movement rations to monsters at the start of a turn */
+void
+allot_mon_movement()
+{
+    struct monst *mtmp;
+
+    mready_cnt = 0;
+    for (mtmp = fmon; mtmp; mtmp = mtmp->nmon) {
+        mtmp->movement += mcalcmove(mtmp);
+        if (mtmp->movement >= NORMAL_SPEED || mtmp->isgd)
+            mready_add(mtmp);
+    }
+    mready_stale = FALSE;
+}
+
+STATIC_OVL void
+mready_add(mtmp)
+struct monst *mtmp;
+{
+    if (mready_cnt == mready_siz) {
+        struct monst **newready;
+
+        mready_siz = mready_siz ? 2 * mready_siz : 64;
+        newready = (struct monst **) alloc(mready_siz * sizeof *newready);
+        if (mready_cnt)
+            (void) memcpy((genericptr_t) newready, (genericptr_t) mready,
+                          mready_cnt * sizeof *newready);
+        if (mready)
+            free((genericptr_t) mready);
+        mready = newready;
+    }
+    mready[mready_cnt++] = mtmp;
+}
+
 /* actions that happen once per ``turn'', regardless of each
    individual monster's metabolism; some of these might need to
    be reclassified to occur more in proportion with movement rate */
@@ -674,6 +722,8 @@ movemon()
 {
     register struct monst *mtmp, *nmtmp;
     register boolean somebody_can_move = FALSE;
+    boolean walkfmon = mready_stale, rebuilding = mready_stale;
+    int ridx = 0, keep = 0;
 
     /*
      * Some of you may remember the former assertion here that
@@ -692,9 +742,35 @@ movemon()
      * and drink cursed potions of raise level to change levels.  These are
      * all reflexive at this point.  Should one monster be able to level
      * teleport another, this scheme would have problems.
+     *
+     * Normally only the monsters gathered in mready[] by the previous
+     * pass (or by allot_mon_movement()) are visited, in fmon order;
+     * monsters not in it have no movement left so the full walk would
+     * skip them anyway.  If fmon gained a member, the rest of the pass
+     * falls back to walking fmon from where we are, which is what the
+     * full walk would have done, and the next pass rebuilds mready[].
      */
 
-    for (mtmp = fmon; mtmp; mtmp = nmtmp) {
+    if (rebuilding)
+        mready_cnt = 0;
+    mready_stale = FALSE;
+    for (nmtmp = fmon;;) {
+        if (!walkfmon && mready_stale)
+            walkfmon = TRUE;
+        if (walkfmon) {
+            if (!(mtmp = nmtmp))
+                break;
+        } else {
+            mtmp = (struct monst *) 0;
+            while (!mtmp && ridx < mready_cnt) {
+                mtmp = mready[ridx++];
+                /* skip monsters since freed (nulled) or moved off fmon */
+                if (mtmp && mtmp->mchain != MCHAIN_FMON)
+                    mtmp = (struct monst *) 0;
+            }
+            if (!mtmp)
+                break;
+        }
         /* end monster movement early if hero is flagged to leave the level */
         if (u.utotype
 #ifdef SAFERHANGUP
@@ -703,13 +779,21 @@ movemon()
 #endif
             ) {
             somebody_can_move = FALSE;
+            mready_stale = TRUE;
             break;
         }
         nmtmp = mtmp->nmon;
         /* one dead monster needs to perform a move after death:
            vault guard whose temporary corridor is still on the map */
-        if (mtmp->isgd && !mtmp->mx && mtmp->mhp <= 0)
-            (void) gd_move(mtmp);
+        if (mtmp->isgd) {
+            /* guards are kept in mready[] whether they can move or not */
+            if (!walkfmon)
+                mready[keep++] = mtmp;
+            else if (rebuilding)
+                mready_add(mtmp);
+            if (!mtmp->mx && mtmp->mhp <= 0)
+                (void) gd_move(mtmp);
+        }
         if (DEADMONSTER(mtmp))
             continue;
 
@@ -718,8 +802,16 @@ movemon()
             continue;
 
         mtmp->movement -= NORMAL_SPEED;
-        if (mtmp->movement >= NORMAL_SPEED)
+        if (mtmp->movement >= NORMAL_SPEED) {
             somebody_can_move = TRUE;
+            /* it will be back for another move next pass */
+            if (!mtmp->isgd) { /* guards have already been kept */
+                if (!walkfmon)
+                    mready[keep++] = mtmp;
+                else if (rebuilding)
+                    mready_add(mtmp);
+            }
+        }
 
         if (vision_full_recalc)
             vision_recalc(0); /* vision! */
@@ -768,16 +860,22 @@ movemon()
         if (dochugw(mtmp)) /* otherwise just move the monster */
             continue;
     }
+    /* when driven by mready[], keep what carries over to the next pass
+       (moot if this pass switched to walking fmon; it's stale now) */
+    if (!rebuilding)
+        mready_cnt = keep;
 
-    if (any_light_source())
-        vision_full_recalc = 1; /* in case a mon moved with a light source */
+    if (light_sources_moved())
+        vision_full_recalc = 1; /* a mon moved with a light source */
     /* reset obj bypasses after last monster has moved */
     if (context.bypasses)
         clear_bypasses();
     clear_splitobjs();
     /* remove dead monsters; dead vault guard will be left at <0,0>
-       if temporary corridor out of vault hasn't been removed yet */
-    dmonsfree();
+       if temporary corridor out of vault hasn't been removed yet;
+       skip walking fmon when nothing has died */
+    if (iflags.purge_monsters)
+        dmonsfree();
 
     /* a monster may have levteleported player -dlc */
     if (u.utotype) {
@@ -1583,6 +1681,7 @@ struct monst *mtmp, *mtmp2;
     }
     mtmp2->nmon = fmon;
     fmon = mtmp2;
+    index_mon_id(mtmp2, MCHAIN_FMON);
     if (u.ustuck == mtmp)
         u.ustuck = mtmp2;
     if (u.usteed == mtmp)
@@ -1640,9 +1739,12 @@ struct monst **monst_list; /* &migrating_mons or &mydogs or null */
         /* insert into mydogs or migrating_mons */
         mon->nmon = *monst_list;
         *monst_list = mon;
+        mon->mchain = (monst_list == &mydogs) ? MCHAIN_MYDOGS
+                                              : MCHAIN_MIGRATE;
     } else {
         /* orphan has no next monster */
         mon->nmon = 0;
+        mon->mchain = MCHAIN_NONE;
     }
 }
 
@@ -1718,13 +1820,33 @@ void
 dealloc_monst(mon)
 struct monst *mon;
 {
+    int i;
+
     if (mon->nmon)
         panic("dealloc_monst with nmon");
     if (mon->mextra)
         dealloc_mextra(mon);
+    for (i = 0; i < mready_cnt; i++)
+        if (mready[i] == mon)
+            mready[i] = (struct monst *) 0;
+    (void) idmap_remove(&mon_id_map, mon->m_id, monst_to_any(mon));
     free((genericptr_t) mon);
 }
 
+/* make a monster findable by find_mid() and note which chain it's on;
+   must be called whenever a monster is put on one of the chains */
+void
+index_mon_id(mon, chain)
+struct monst *mon;
+int chain;
+{
+    mon->mchain = chain;
+    idmap_add(&mon_id_map, mon->m_id, monst_to_any(mon));
+    /* a new member of fmon upsets movemon()'s ready list */
+    if (chain == MCHAIN_FMON)
+        mready_stale = TRUE;
+}
+
 /* remove effects of mtmp from other data structures */
 STATIC_OVL void
 m_detach(mtmp, mptr)
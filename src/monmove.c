@@ -16,6 +16,10 @@ STATIC_DCL void FDECL(distfleeck, (struct monst *, int *, int *, int *));
 STATIC_DCL int FDECL(m_arrival, (struct monst *));
 STATIC_DCL boolean FDECL(stuff_prevents_passage, (struct monst *));
 STATIC_DCL int FDECL(vamp_shift, (struct monst *, struct permonst *, BOOLEAN_P));
+#ifdef APPROACH_MAP
+STATIC_DCL void NDECL(build_approach_map);
+STATIC_DCL int FDECL(approach_dist, (int, int));
+#endif
 
 /* True if mtmp died */
 boolean
@@ -742,6 +746,74 @@ xchar nix,niy;
     return FALSE;
 }
 
+#ifdef APPROACH_MAP
+/*
+ * Number of moves an ordinary walker needs to reach the hero from each
+ * location, or -1 if it can't.  Boulders and water stop it, doors don't
+ * (but can't be entered or left diagonally).  Every monster closing in
+ * on the hero shares this; it is built on first use in a turn and is
+ * thrown away when the hero moves or the terrain changes.
+ */
+static short approach_map[COLNO][ROWNO];
+static long approach_moves = -1L; /* turn approach_map was built for */
+static xchar approach_ux, approach_uy; /* where the hero was then */
+
+#define approach_doorway(x, y) \
+    (IS_DOOR(levl[x][y].typ)  \
+     && (levl[x][y].doormask & ~(D_NODOOR | D_BROKEN)) != 0)
+
+STATIC_OVL void
+build_approach_map()
+{
+    static coord queue[COLNO * ROWNO];
+    int head, tail, x, y, nx, ny, dx, dy;
+    short d;
+
+    (void) memset((genericptr_t) approach_map, -1, sizeof approach_map);
+    approach_moves = moves;
+    approach_ux = u.ux, approach_uy = u.uy;
+
+    approach_map[u.ux][u.uy] = 0;
+    queue[0].x = u.ux, queue[0].y = u.uy;
+    for (head = 0, tail = 1; head < tail; head++) {
+        x = queue[head].x, y = queue[head].y;
+        d = approach_map[x][y] + 1;
+        for (dx = -1; dx <= 1; dx++)
+            for (dy = -1; dy <= 1; dy++) {
+                nx = x + dx, ny = y + dy;
+                if (!isok(nx, ny) || approach_map[nx][ny] >= 0
+                    || !ACCESSIBLE(levl[nx][ny].typ)
+                    || sobj_at(BOULDER, nx, ny))
+                    continue;
+                if (dx && dy
+                    && (approach_doorway(x, y) || approach_doorway(nx, ny)))
+                    continue;
+                approach_map[nx][ny] = d;
+                queue[tail].x = nx, queue[tail].y = ny;
+                tail++;
+            }
+    }
+}
+
+/* moves from <x,y> to the hero; approach_map is rebuilt if out of date */
+STATIC_OVL int
+approach_dist(x, y)
+int x, y;
+{
+    if (approach_moves != moves || approach_ux != u.ux
+        || approach_uy != u.uy)
+        build_approach_map();
+    return approach_map[x][y];
+}
+
+/* terrain has changed or the hero has changed levels */
+void
+approach_map_stale()
+{
+    approach_moves = -1L;
+}
+#endif /* APPROACH_MAP */
+
 /* Return values:
  * 0: did not move, but can still attack and do other stuff.
  * 1: moved, possibly can attack.
@@ -1094,6 +1166,9 @@ not_special:
         register int i, j, nx, ny, nearer;
         int jcnt, cnt;
         int ndist, nidist;
+#ifdef APPROACH_MAP
+        int mapd = -1, nmapd = -1;
+#endif
         register coord *mtrk;
         coord poss[9];
 
@@ -1106,6 +1181,13 @@ not_special:
         if (!mtmp->mpeaceful && level.flags.shortsighted
             && nidist > (couldsee(nix, niy) ? 144 : 36) && appr == 1)
             appr = 0;
+#ifdef APPROACH_MAP
+        /* heading for the hero: go around walls and boulders rather than
+           straight at them, unless they're no obstacle */
+        if (appr == 1 && gx == u.ux && gy == u.uy && !u.uswallow
+            && !passes_walls(ptr) && !can_tunnel)
+            mapd = approach_dist(omx, omy);
+#endif
         if (is_unicorn(ptr) && level.flags.noteleport) {
             /* on noteleport levels, perhaps we cannot avoid hero */
             for (i = 0; i < cnt; i++)
@@ -1132,12 +1214,23 @@ not_special:
             }
 
             nearer = ((ndist = dist2(nx, ny, gx, gy)) < nidist);
+#ifdef APPROACH_MAP
+            if (mapd >= 0) {
+                if ((nmapd = approach_dist(nx, ny)) < 0)
+                    nmapd = COLNO * ROWNO;
+                nearer = (nmapd < mapd || (nmapd == mapd && nearer));
+            }
+#endif
 
             if ((appr == 1 && nearer) || (appr == -1 && !nearer)
                 || (!appr && !rn2(++chcnt)) || !mmoved) {
                 nix = nx;
                 niy = ny;
                 nidist = ndist;
+#ifdef APPROACH_MAP
+                if (mapd >= 0)
+                    mapd = nmapd;
+#endif
                 chi = i;
                 mmoved = 1;
             }
@@ -106,6 +106,9 @@ static struct Bool_Opt {
     { "color", &iflags.wc_color, TRUE, SET_IN_GAME }, /*WC*/
 #else /* systems that support multiple terminals, many monochrome */
     { "color", &iflags.wc_color, FALSE, SET_IN_GAME }, /*WC*/
+#endif
+#ifdef COLCOMP
+    { "colcomp", &iflags.colcomp, FALSE, DISP_IN_GAME },
 #endif
     { "confirm", &flags.confirm, TRUE, SET_IN_GAME },
     { "dark_room", &flags.dark_room, TRUE, SET_IN_GAME },
@@ -145,6 +148,9 @@ static struct Bool_Opt {
     { "legacy", &flags.legacy, TRUE, DISP_IN_GAME },
     { "lit_corridor", &flags.lit_corridor, FALSE, SET_IN_GAME },
     { "lootabc", &flags.lootabc, FALSE, SET_IN_GAME },
+#ifdef LZCOMP
+    { "lzcomp", &iflags.lzcomp, TRUE, DISP_IN_GAME },
+#endif
 #ifdef MAIL
     { "mail", &flags.biff, TRUE, SET_IN_GAME },
 #else
@@ -195,6 +201,9 @@ static struct Bool_Opt {
 #endif
     { "safe_pet", &flags.safe_dog, TRUE, SET_IN_GAME },
     { "sanity_check", &iflags.sanity_check, FALSE, SET_IN_WIZGAME },
+#ifdef SAVECRC
+    { "savecrc", &iflags.savecrc, TRUE, DISP_IN_GAME },
+#endif
     { "selectsaved", &iflags.wc2_selectsaved, TRUE, DISP_IN_GAME }, /*WC*/
     { "showexp", &flags.showexp, FALSE, SET_IN_GAME },
     { "showrace", &flags.showrace, FALSE, SET_IN_GAME },
@@ -220,6 +229,7 @@ static struct Bool_Opt {
     { "tombstone", &flags.tombstone, TRUE, SET_IN_GAME },
     { "toptenwin", &iflags.toptenwin, FALSE, SET_IN_GAME },
     { "travel", &flags.travelcmd, TRUE, SET_IN_GAME },
+    { "uniform_text", &iflags.uniform_text, FALSE, SET_IN_GAME },
     { "use_darkgray", &iflags.wc2_darkgray, TRUE, SET_IN_FILE },
 #ifdef WIN32
     { "use_inverse", &iflags.wc_inverse, TRUE, SET_IN_GAME }, /*WC*/
@@ -699,6 +709,18 @@ initoptions_init()
     set_restpref("rlecomp");
 #endif
 #endif
+#ifdef LZCOMP
+    set_savepref("lzcomp");
+    set_restpref("lzcomp");
+#endif
+#ifdef COLCOMP
+    set_savepref("!colcomp");
+    set_restpref("!colcomp");
+#endif
+#ifdef SAVECRC
+    set_savepref("savecrc");
+    set_restpref("savecrc");
+#endif
 #ifdef SYSFLAGS
     Strcpy(sysflags.sysflagsid, "sysflags");
     sysflags.sysflagsid[9] = (char) sizeof(struct sysflag);
@@ -3720,9 +3742,24 @@ boolean tinitial, tfrom_file;
             if (boolopt[i].addr == &iflags.rlecomp)
                 set_savepref(iflags.rlecomp ? "rlecomp" : "!rlecomp");
 #endif
+#ifdef COLCOMP
+            if (boolopt[i].addr == &iflags.colcomp)
+                set_savepref(iflags.colcomp ? "colcomp" : "!colcomp");
+#endif
+#ifdef SAVECRC
+            if (boolopt[i].addr == &iflags.savecrc)
+                set_savepref(iflags.savecrc ? "savecrc" : "!savecrc");
+#endif
 #ifdef ZEROCOMP
             if (boolopt[i].addr == &iflags.zerocomp)
                 set_savepref(iflags.zerocomp ? "zerocomp" : "externalcomp");
+#endif
+#ifdef LZCOMP
+            /* lzcomp takes precedence over zerocomp */
+            if (boolopt[i].addr == &iflags.lzcomp
+                || (boolopt[i].addr == &iflags.zerocomp && iflags.lzcomp))
+                set_savepref(iflags.lzcomp ? "lzcomp"
+                             : iflags.zerocomp ? "zerocomp" : "externalcomp");
 #endif
             if (boolopt[i].addr == &iflags.wc_ascii_map) {
                 /* toggling ascii_map; set tiled_map to its opposite;
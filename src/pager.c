@@ -15,6 +15,9 @@ STATIC_DCL void FDECL(look_at_object, (char *, int, int, int));
 STATIC_DCL void FDECL(look_at_monster, (char *, char *,
                                         struct monst *, int, int));
 STATIC_DCL struct permonst *FDECL(lookat, (int, int, char *, char *));
+STATIC_DCL unsigned FDECL(datakey_hash, (const char *));
+STATIC_DCL boolean FDECL(load_datakeys, (dlb *));
+STATIC_DCL boolean FDECL(find_datakey, (const char *, long *, int *));
 STATIC_DCL void FDECL(checkfile, (char *, struct permonst *,
                                   BOOLEAN_P, BOOLEAN_P));
 STATIC_DCL void FDECL(look_all, (BOOLEAN_P,BOOLEAN_P));
@@ -494,6 +497,186 @@ char *buf, *monbuf;
     return (pm && !Hallucination) ? pm : (struct permonst *) 0;
 }
 
+/*
+ * Key index for the "data" file, built by makedefs and loaded on the first
+ * lookup.  Literal keys are hashed; keys containing '*' or '?' are kept in
+ * a separate list and matched with pmatch().  Each key carries its ordinal
+ * in data.base so that the result is the same one that a sequential scan
+ * of the key section would find.
+ */
+struct datakey {
+    char *key;            /* key text, without any leading '~' */
+    long offset;          /* offset of entry's text, relative to txt_offset */
+    int count;            /* number of lines of text */
+    int ordinal;          /* position of key in data.base */
+    int taillen;          /* wildcard key: length of text after last '*' */
+    boolean skip;         /* "~" key: a match skips this entry */
+    struct datakey *next; /* next literal key in same hash bucket */
+};
+
+static struct datakey *datakeys = 0, **datahash = 0;
+static int n_datakeys = 0, n_literal = 0;
+static unsigned datahashsiz = 0;
+static unsigned long data_txt_offset = 0L;
+
+STATIC_DCL boolean FDECL(datakey_match, (struct datakey *, const char *,
+                                     int));
+
+STATIC_OVL unsigned
+datakey_hash(key)
+const char *key;
+{
+    unsigned long h = 2166136261UL; /* FNV-1a */
+
+    while (*key)
+        h = ((h ^ (unsigned char) *key++) * 16777619UL) & 0xffffffffUL;
+    return (unsigned) (h & (datahashsiz - 1));
+}
+
+/* read the key index; fp is left at an unspecified position */
+STATIC_OVL boolean
+load_datakeys(fp)
+dlb *fp;
+{
+    char buf[BUFSZ], *ep, *kp;
+    unsigned long idx_offset = 0L;
+    int i, n_wild, ordinal, count;
+    long offset;
+    struct datakey *dk;
+
+    if (dlb_fseek(fp, 0L, SEEK_SET) < 0
+        || !dlb_fgets(buf, BUFSZ, fp) || !dlb_fgets(buf, BUFSZ, fp)
+        || sscanf(buf, "%8lx %8lx", &data_txt_offset, &idx_offset) < 2
+        || !data_txt_offset || !idx_offset
+        || dlb_fseek(fp, (long) idx_offset, SEEK_SET) < 0
+        || !dlb_fgets(buf, BUFSZ, fp)
+        || sscanf(buf, "%d %d", &n_literal, &n_wild) < 2
+        || n_literal < 0 || n_wild < 0)
+        return FALSE;
+
+    n_datakeys = n_literal + n_wild;
+    datakeys = (struct datakey *) alloc((unsigned) ((n_datakeys ? n_datakeys
+                                                                 : 1)
+                                                    * sizeof *datakeys));
+    for (datahashsiz = 16; datahashsiz < 2 * (unsigned) n_literal;)
+        datahashsiz <<= 1;
+    datahash = (struct datakey **) alloc(datahashsiz * sizeof *datahash);
+    for (i = 0; i < (int) datahashsiz; i++)
+        datahash[i] = (struct datakey *) 0;
+
+    for (i = 0; i < n_datakeys; i++) {
+        dk = &datakeys[i];
+        dk->key = (char *) 0;
+        if (!dlb_fgets(buf, BUFSZ, fp) || !(ep = index(buf, '\n'))
+            || sscanf(buf, "%d %ld,%d", &ordinal, &offset, &count) < 3
+            || !(kp = index(buf, ' ')) || !(kp = index(kp + 1, ' ')))
+            break;
+        (void) strip_newline((ep > buf) ? ep - 1 : ep);
+        dk->skip = (*++kp == '~');
+        dk->key = dupstr(kp + dk->skip);
+        dk->offset = offset;
+        dk->count = count;
+        dk->ordinal = ordinal;
+        dk->next = (struct datakey *) 0;
+        kp = rindex(dk->key, '*');
+        dk->taillen = kp ? (int) strlen(kp + 1) : -1;
+    }
+    if (i < n_datakeys) {
+        n_datakeys = i;
+        free_datakeys();
+        return FALSE;
+    }
+    /* literal keys are in ordinal order; chain them so that buckets are
+       too, by inserting from the back */
+    for (i = n_literal - 1; i >= 0; i--) {
+        unsigned h = datakey_hash(datakeys[i].key);
+
+        datakeys[i].next = datahash[h];
+        datahash[h] = &datakeys[i];
+    }
+    return TRUE;
+}
+
+/* pmatch() for a wildcard key, rejecting on the text after its last '*'
+   first since most of them start with one */
+STATIC_OVL boolean
+datakey_match(dk, str, len)
+struct datakey *dk;
+const char *str;
+int len;
+{
+    const char *kp, *sp;
+
+    if (dk->taillen > 0) {
+        if (dk->taillen > len)
+            return FALSE;
+        for (kp = eos(dk->key) - dk->taillen, sp = &str[len - dk->taillen];
+             *kp; kp++, sp++)
+            if (*kp != *sp && *kp != '?')
+                return FALSE;
+    }
+    return pmatch(dk->key, str);
+}
+
+/* find the entry a sequential scan of the data.base keys would pick */
+STATIC_OVL boolean
+find_datakey(str, offset, count)
+const char *str;
+long *offset;
+int *count;
+{
+    struct datakey *lk, *wk, *dk, *wend = &datakeys[n_datakeys];
+    long skipped = -1L;
+    int len = (int) strlen(str);
+
+    for (lk = datahash[datakey_hash(str)]; lk; lk = lk->next)
+        if (!strcmp(lk->key, str))
+            break;
+    for (wk = &datakeys[n_literal]; wk < wend; wk++)
+        if (datakey_match(wk, str, len))
+            break;
+
+    /* merge literal and wildcard matches in data.base order */
+    while (lk || wk < wend) {
+        if (lk && (wk == wend || lk->ordinal < wk->ordinal)) {
+            dk = lk;
+            while ((lk = lk->next) != 0 && strcmp(lk->key, str))
+                continue;
+        } else {
+            dk = wk;
+            while (++wk < wend && !datakey_match(wk, str, len))
+                continue;
+        }
+        if (dk->offset == skipped)
+            continue; /* entry already rejected by a "~" key */
+        if (dk->skip) {
+            skipped = dk->offset;
+            continue;
+        }
+        *offset = dk->offset;
+        *count = dk->count;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+void
+free_datakeys()
+{
+    int i;
+
+    if (datakeys) {
+        for (i = 0; i < n_datakeys; i++)
+            if (datakeys[i].key)
+                free((genericptr_t) datakeys[i].key);
+        free((genericptr_t) datakeys), datakeys = 0;
+    }
+    if (datahash)
+        free((genericptr_t) datahash), datahash = 0;
+    n_datakeys = n_literal = 0;
+    datahashsiz = 0;
+}
+
 /*
  * Look in the "data" file for more info.  Called if the user typed in the
  * whole name (user_typed_name == TRUE), or we've found a possible match
@@ -612,9 +795,8 @@ boolean user_typed_name, without_asking;
     /* Make sure the name is non-empty. */
     if (*dbase_str) {
         long pass1offset = -1L;
-        int chk_skip, pass = 1;
-        boolean yes_to_moreinfo, found_in_file, pass1found_in_file,
-                skipping_entry;
+        int pass = 1;
+        boolean yes_to_moreinfo, found_in_file, pass1found_in_file;
         char *ap, *alt = 0; /* alternate description */
 
         /* adjust the input to remove "named " and "called " */
@@ -645,63 +827,21 @@ boolean user_typed_name, without_asking;
         if (!alt)
             alt = makesingular(dbase_str);
 
+        if (!datakeys && !load_datakeys(fp))
+            goto bad_data_file;
+        txt_offset = data_txt_offset;
+
         pass1found_in_file = FALSE;
         for (pass = !strcmp(alt, dbase_str) ? 0 : 1; pass >= 0; --pass) {
-            found_in_file = skipping_entry = FALSE;
-            txt_offset = 0L;
-            if (dlb_fseek(fp, txt_offset, SEEK_SET) < 0 ) {
-                impossible("can't get to start of 'data' file");
-                goto checkfile_done;
-            }
-            /* skip first record; read second */
-            if (!dlb_fgets(buf, BUFSZ, fp) || !dlb_fgets(buf, BUFSZ, fp)) {
-                impossible("can't read 'data' file");
-                goto checkfile_done;
-            } else if (sscanf(buf, "%8lx\n", &txt_offset) < 1
-                       || txt_offset == 0L)
-                goto bad_data_file;
-
-            /* look for the appropriate entry */
-            while (dlb_fgets(buf, BUFSZ, fp)) {
-                if (*buf == '.')
-                    break; /* we passed last entry without success */
-
-                if (digit(*buf)) {
-                    /* a number indicates the end of current entry */
-                    skipping_entry = FALSE;
-                } else if (!skipping_entry) {
-                    if (!(ep = index(buf, '\n')))
-                        goto bad_data_file;
-                    (void) strip_newline((ep > buf) ? ep - 1 : ep);
-                    /* if we match a key that begins with "~", skip
-                       this entry */
-                    chk_skip = (*buf == '~') ? 1 : 0;
-                    if ((pass == 0 && pmatch(&buf[chk_skip], dbase_str))
-                        || (pass == 1 && alt && pmatch(&buf[chk_skip], alt))) {
-                        if (chk_skip) {
-                            skipping_entry = TRUE;
-                            continue;
-                        } else {
-                            found_in_file = TRUE;
-                            if (pass == 1)
-                                pass1found_in_file = TRUE;
-                            break;
-                        }
-                    }
-                }
-            }
+            long entry_offset, fseekoffset;
+            int entry_count;
+            int i;
+
+            found_in_file = find_datakey(pass ? alt : dbase_str,
+                                         &entry_offset, &entry_count);
             if (found_in_file) {
-                long entry_offset, fseekoffset;
-                int entry_count;
-                int i;
-
-                /* skip over other possible matches for the info */
-                do {
-                    if (!dlb_fgets(buf, BUFSZ, fp))
-                        goto bad_data_file;
-                } while (!digit(*buf));
-                if (sscanf(buf, "%ld,%d\n", &entry_offset, &entry_count) < 2)
-                    goto bad_data_file;
+                if (pass == 1)
+                    pass1found_in_file = TRUE;
                 fseekoffset = (long) txt_offset + entry_offset;
                 if (pass == 1)
                     pass1offset = fseekoffset;
@@ -21,6 +21,11 @@ STATIC_DCL void NDECL(zerocomp_minit);
 STATIC_DCL void FDECL(zerocomp_mread, (int, genericptr_t, unsigned int));
 STATIC_DCL int NDECL(zerocomp_mgetc);
 #endif
+#ifdef LZCOMP
+STATIC_DCL void NDECL(lzcomp_minit);
+STATIC_DCL void FDECL(lzcomp_mread, (int, genericptr_t, unsigned int));
+STATIC_DCL boolean FDECL(lzcomp_getblock, (int));
+#endif
 
 STATIC_DCL void NDECL(def_minit);
 STATIC_DCL void FDECL(def_mread, (int, genericptr_t, unsigned int));
@@ -31,7 +36,7 @@ STATIC_DCL void FDECL(restdamage, (int, BOOLEAN_P));
 STATIC_DCL void FDECL(restobj, (int, struct obj *));
 STATIC_DCL struct obj *FDECL(restobjchn, (int, BOOLEAN_P, BOOLEAN_P));
 STATIC_OVL void FDECL(restmon, (int, struct monst *));
-STATIC_DCL struct monst *FDECL(restmonchn, (int, BOOLEAN_P));
+STATIC_DCL struct monst *FDECL(restmonchn, (int, int, BOOLEAN_P));
 STATIC_DCL struct fruit *FDECL(loadfruitchn, (int));
 STATIC_DCL void FDECL(freefruitchn, (struct fruit *));
 STATIC_DCL void FDECL(ghostfruit, (struct obj *));
@@ -42,6 +47,13 @@ STATIC_DCL int FDECL(restlevelfile, (int, XCHAR_P));
 STATIC_OVL void FDECL(restore_msghistory, (int));
 STATIC_DCL void FDECL(reset_oattached_mids, (BOOLEAN_P));
 STATIC_DCL void FDECL(rest_levl, (int, BOOLEAN_P));
+#ifdef COLCOMP
+STATIC_DCL void FDECL(rest_levl_planes, (int));
+STATIC_DCL void FDECL(rest_levl_plane, (int, int));
+#endif
+#ifdef SAVECRC
+STATIC_DCL boolean FDECL(crc_getchunk, (int));
+#endif
 
 static struct restore_procs {
     const char *name;
@@ -60,21 +72,12 @@ static struct restore_procs {
 /*
  * Save a mapping of IDs from ghost levels to the current level.  This
  * map is used by the timer routines when restoring ghost levels.
+ * Keyed by ghost ID; the value is the new ID.
  */
-#define N_PER_BUCKET 64
-struct bucket {
-    struct bucket *next;
-    struct {
-        unsigned gid; /* ghost ID */
-        unsigned nid; /* new ID */
-    } map[N_PER_BUCKET];
-};
-
 STATIC_DCL void NDECL(clear_id_mapping);
 STATIC_DCL void FDECL(add_id_mapping, (unsigned, unsigned));
 
-static int n_ids_mapped = 0;
-static struct bucket *id_map = 0;
+static idmap_t id_map = { 0, 0, 0 };
 
 #ifdef AMII_GRAPHICS
 void FDECL(amii_setpens, (int)); /* use colors from save file */
@@ -287,6 +290,7 @@ boolean ghostly, frozen;
             add_id_mapping(otmp->o_id, nid);
             otmp->o_id = nid;
         }
+        index_obj_id(otmp);
         if (ghostly && otmp->otyp == SLIME_MOLD)
             ghostfruit(otmp);
         /* Ghost levels get object age shifted from old player's clock
@@ -384,8 +388,9 @@ struct monst *mtmp;
 }
 
 STATIC_OVL struct monst *
-restmonchn(fd, ghostly)
+restmonchn(fd, chain, ghostly)
 register int fd;
+int chain; /* MCHAIN_FMON or MCHAIN_MIGRATE */
 boolean ghostly;
 {
     register struct monst *mtmp, *mtmp2 = 0;
@@ -409,6 +414,7 @@ boolean ghostly;
             add_id_mapping(mtmp->m_id, nid);
             mtmp->m_id = nid;
         }
+        index_mon_id(mtmp, chain);
         offset = mtmp->mnum;
         mtmp->data = &mons[offset];
         if (ghostly) {
@@ -617,7 +623,7 @@ unsigned int *stuckid, *steedid;
     }
 
     migrating_objs = restobjchn(fd, FALSE, FALSE);
-    migrating_mons = restmonchn(fd, FALSE);
+    migrating_mons = restmonchn(fd, MCHAIN_MIGRATE, FALSE);
     mread(fd, (genericptr_t) mvitals, sizeof(mvitals));
 
     /*
@@ -739,7 +745,7 @@ xchar ltmp;
              */
             playwoRAMdisk();
             /* Rewind save file and try again */
-            (void) lseek(fd, (off_t) 0, 0);
+            (void) nhseek(fd, 0L);
             (void) validate(fd, (char *) 0); /* skip version etc */
             return dorecover(fd);            /* 0 or 1 */
         }
@@ -836,11 +842,7 @@ register int fd;
     }
     restoreprocs.mread_flags = 0;
 
-#ifdef BSD
-    (void) lseek(fd, 0L, 0);
-#else
-    (void) lseek(fd, (off_t) 0, 0);
-#endif
+    (void) nhseek(fd, 0L);
     (void) validate(fd, (char *) 0); /* skip version and savefile info */
     get_plname_from_file(fd, plname);
 
@@ -918,6 +920,81 @@ struct cemetery **cemeteryaddr;
     }
 }
 
+#ifdef COLCOMP
+/* the encoding of one field of every map location (see rm.h), and the
+   decoded planes, row by row, that levl[][] gets put back together from */
+static uchar colbuf[LP_MAXLEN];
+static uchar colplanes[NUM_LEVL_PLANES][ROWNO * COLNO];
+static int colglyphs[ROWNO * COLNO];
+
+STATIC_OVL void
+rest_levl_plane(fd, plane)
+int fd, plane;
+{
+    uchar *p = colbuf, *end;
+    int i, k, n, val;
+    unsigned len;
+
+    mread(fd, (genericptr_t) &len, sizeof len);
+    if (len > sizeof colbuf)
+        panic("rest_levl: map plane %d too long (%u)", plane, len);
+    mread(fd, (genericptr_t) colbuf, len);
+    end = colbuf + len;
+
+    val = 0;
+    for (i = 0; i < ROWNO * COLNO; i += n) {
+        if (end - p < 2)
+            break;
+        n = *p++;
+        if (n < 1 || n > ROWNO * COLNO - i)
+            break;
+        if (plane != LP_GLYPH) {
+            (void) memset((genericptr_t) &colplanes[plane][i], *p++, n);
+            continue;
+        }
+        if (*p == LP_ESC) {
+            if (end - p < 5)
+                break;
+            val = (int) ((unsigned) p[1] | ((unsigned) p[2] << 8)
+                         | ((unsigned) p[3] << 16) | ((unsigned) p[4] << 24));
+            p += 5;
+        } else {
+            val += (schar) *p++;
+        }
+        for (k = 0; k < n; k++)
+            colglyphs[i + k] = val;
+    }
+    if (i < ROWNO * COLNO || p != end)
+        panic("rest_levl: bad map plane %d", plane);
+}
+
+/* read back what savelevl_planes() wrote */
+STATIC_OVL void
+rest_levl_planes(fd)
+int fd;
+{
+    struct rm *lev;
+    int plane, x, y, i;
+
+    for (plane = 0; plane < NUM_LEVL_PLANES; plane++)
+        rest_levl_plane(fd, plane);
+    for (i = 0, y = 0; y < ROWNO; y++)
+        for (x = 0; x < COLNO; x++, i++) {
+            lev = &levl[x][y];
+            lev->glyph = colglyphs[i];
+            lev->typ = (schar) colplanes[LP_TYP][i];
+            lev->seenv = colplanes[LP_SEENV][i];
+            lev->flags = colplanes[LP_FLAGS][i];
+            lev->horizontal = colplanes[LP_HORIZONTAL][i];
+            lev->lit = colplanes[LP_LIT][i];
+            lev->waslit = colplanes[LP_WASLIT][i];
+            lev->roomno = colplanes[LP_ROOMNO][i];
+            lev->edge = colplanes[LP_EDGE][i];
+            lev->candig = colplanes[LP_CANDIG][i];
+        }
+}
+#endif /* COLCOMP */
+
 /*ARGSUSED*/
 STATIC_OVL void
 rest_levl(fd, rlecomp)
@@ -1018,8 +1095,13 @@ boolean ghostly;
         trickery(trickbuf);
     }
     restcemetery(fd, &level.bonesinfo);
-    rest_levl(fd,
-              (boolean) ((sfrestinfo.sfi1 & SFI1_RLECOMP) == SFI1_RLECOMP));
+#ifdef COLCOMP
+    if ((sfrestinfo.sfi1 & SFI1_COLCOMP) == SFI1_COLCOMP)
+        rest_levl_planes(fd);
+    else
+#endif
+        rest_levl(fd, (boolean) ((sfrestinfo.sfi1 & SFI1_RLECOMP)
+                                 == SFI1_RLECOMP));
     mread(fd, (genericptr_t) lastseentyp, sizeof(lastseentyp));
     mread(fd, (genericptr_t) &omoves, sizeof(omoves));
     elapsed = monstermoves - omoves;
@@ -1040,15 +1122,19 @@ boolean ghostly;
 
     restore_timers(fd, RANGE_LEVEL, ghostly, elapsed);
     restore_light_sources(fd);
-    fmon = restmonchn(fd, ghostly);
+    fmon = restmonchn(fd, MCHAIN_FMON, ghostly);
 
     rest_worm(fd); /* restore worm information */
     ftrap = 0;
+    for (x = 0; x < COLNO; x++)
+        for (y = 0; y < ROWNO; y++)
+            level.traps[x][y] = (struct trap *) 0;
     while (trap = newtrap(),
            mread(fd, (genericptr_t) trap, sizeof(struct trap)),
            trap->tx != 0) { /* need "!= 0" to work around DICE 3.0 bug */
         trap->ntrap = ftrap;
         ftrap = trap;
+        level.traps[trap->tx][trap->ty] = trap;
     }
     dealloc_trap(trap);
     fobj = restobjchn(fd, ghostly, FALSE);
@@ -1161,8 +1247,8 @@ int fd;
 char *plbuf;
 {
     int pltmpsiz = 0;
-    (void) read(fd, (genericptr_t) &pltmpsiz, sizeof(pltmpsiz));
-    (void) read(fd, (genericptr_t) plbuf, pltmpsiz);
+    (void) nhread(fd, (genericptr_t) &pltmpsiz, sizeof(pltmpsiz));
+    (void) nhread(fd, (genericptr_t) plbuf, pltmpsiz);
     return;
 }
 
@@ -1193,13 +1279,7 @@ register int fd;
 STATIC_OVL void
 clear_id_mapping()
 {
-    struct bucket *curr;
-
-    while ((curr = id_map) != 0) {
-        id_map = curr->next;
-        free((genericptr_t) curr);
-    }
-    n_ids_mapped = 0;
+    idmap_empty(&id_map);
 }
 
 /* Add a mapping to the ID map. */
@@ -1207,20 +1287,7 @@ STATIC_OVL void
 add_id_mapping(gid, nid)
 unsigned gid, nid;
 {
-    int idx;
-
-    idx = n_ids_mapped % N_PER_BUCKET;
-    /* idx is zero on first time through, as well as when a new bucket is */
-    /* needed */
-    if (idx == 0) {
-        struct bucket *gnu = (struct bucket *) alloc(sizeof(struct bucket));
-        gnu->next = id_map;
-        id_map = gnu;
-    }
-
-    id_map->map[idx].gid = gid;
-    id_map->map[idx].nid = nid;
-    n_ids_mapped++;
+    idmap_add(&id_map, gid, uint_to_any(nid));
 }
 
 /*
@@ -1232,26 +1299,13 @@ boolean
 lookup_id_mapping(gid, nidp)
 unsigned gid, *nidp;
 {
-    int i;
-    struct bucket *curr;
-
-    if (n_ids_mapped)
-        for (curr = id_map; curr; curr = curr->next) {
-            /* first bucket might not be totally full */
-            if (curr == id_map) {
-                i = n_ids_mapped % N_PER_BUCKET;
-                if (i == 0)
-                    i = N_PER_BUCKET;
-            } else
-                i = N_PER_BUCKET;
-
-            while (--i >= 0)
-                if (gid == curr->map[i].gid) {
-                    *nidp = curr->map[i].nid;
-                    return TRUE;
-                }
-        }
+    anything *val;
+    int cursor = -1;
 
+    if ((val = idmap_next(&id_map, gid, &cursor)) != 0) {
+        *nidp = val->a_uint;
+        return TRUE;
+    }
     return FALSE;
 }
 
@@ -1289,7 +1343,7 @@ winid bannerwin; /* if not WIN_ERR, clear window and show copyright in menu */
 {
     winid tmpwin;
     anything any;
-    char **saved;
+    char **saved, buf[BUFSZ];
     menu_item *chosen_game = (menu_item *) 0;
     int k, clet, ch = 0; /* ch: 0 => new game */
 
@@ -1313,8 +1367,8 @@ winid bannerwin; /* if not WIN_ERR, clear window and show copyright in menu */
                  "Select one of your saved games", MENU_UNSELECTED);
         for (k = 0; saved[k]; ++k) {
             any.a_int = k + 1;
-            add_menu(tmpwin, NO_GLYPH, &any, 0, 0, ATR_NONE, saved[k],
-                     MENU_UNSELECTED);
+            add_menu(tmpwin, NO_GLYPH, &any, 0, 0, ATR_NONE,
+                     describe_saved_game(saved[k], buf), MENU_UNSELECTED);
         }
         clet = (k <= 'n' - 'a') ? 'n' : 0; /* new game */
         any.a_int = -1;                    /* not >= 0 */
@@ -1351,9 +1405,59 @@ winid bannerwin; /* if not WIN_ERR, clear window and show copyright in menu */
 }
 #endif /* SELECTSAVED */
 
+#ifdef SAVECRC
+/* see the description of the format in save.c */
+#define CRC_CHUNKSIZ 16384
+#define CRC_HDRSIZ 8
+
+static NEARDATA unsigned char crc_chunk[CRC_CHUNKSIZ];
+static NEARDATA unsigned crc_chunklen = 0, crc_chunkpos = 0;
+
+/* read and check the next chunk; FALSE if the file ended cleanly before
+   it, which is only allowed where mread() has been told to expect that */
+STATIC_OVL boolean
+crc_getchunk(fd)
+int fd;
+{
+    unsigned char hdr[CRC_HDRSIZ];
+    unsigned long crc = 0L;
+    unsigned len = 0;
+    int i;
+
+    crc_chunklen = crc_chunkpos = 0;
+    (*restoreprocs.restore_mread)(fd, (genericptr_t) hdr, CRC_HDRSIZ);
+    if (restoreprocs.mread_flags == -1)
+        return FALSE;
+    for (i = 3; i >= 0; i--) {
+        len = (len << 8) | hdr[i];
+        crc = (crc << 8) | hdr[4 + i];
+    }
+    if (len && len <= CRC_CHUNKSIZ) {
+        (*restoreprocs.restore_mread)(fd, (genericptr_t) crc_chunk, len);
+        if (restoreprocs.mread_flags != -1
+            && crc32c(0L, (genericptr_t) crc_chunk, len) == crc) {
+            crc_chunklen = len;
+            return TRUE;
+        }
+    }
+    pline("Checksum error in file #%d.", fd);
+    if (restoring) {
+        (void) nhclose(fd);
+        (void) delete_savefile();
+        error("Error restoring old game.");
+    }
+    panic("Error reading level file.");
+    /*NOTREACHED*/
+    return FALSE;
+}
+#endif /* SAVECRC */
+
 void
 minit()
 {
+#ifdef SAVECRC
+    crc_chunklen = crc_chunkpos = 0;
+#endif
     (*restoreprocs.restore_minit)();
     return;
 }
@@ -1364,6 +1468,22 @@ register int fd;
 register genericptr_t buf;
 register unsigned int len;
 {
+#ifdef SAVECRC
+    char *bp = (char *) buf;
+    unsigned n;
+
+    if ((sfrestinfo.sfi1 & SFI1_CRC32C) == SFI1_CRC32C) {
+        while (len) {
+            if (crc_chunkpos >= crc_chunklen && !crc_getchunk(fd))
+                return;
+            n = min(len, crc_chunklen - crc_chunkpos);
+            (void) memcpy((genericptr_t) bp,
+                          (genericptr_t) &crc_chunk[crc_chunkpos], n);
+            crc_chunkpos += n, bp += n, len -= n;
+        }
+        return;
+    }
+#endif
     (*restoreprocs.restore_mread)(fd, buf, len);
     return;
 }
@@ -1388,7 +1508,7 @@ const char *name;
     if (!(reslt = uptodate(fd, name)))
         return 1;
 
-    rlen = read(fd, (genericptr_t) &sfi, sizeof sfi);
+    rlen = nhread(fd, (genericptr_t) &sfi, sizeof sfi);
     minit(); /* ZEROCOMP */
     if (rlen == 0) {
         if (verbose) {
@@ -1401,6 +1521,19 @@ const char *name;
 
     compatible = (sfi.sfi1 & sfcap.sfi1);
 
+    if ((sfi.sfi1 & SFI1_LZCOMP) == SFI1_LZCOMP) {
+        if ((compatible & SFI1_LZCOMP) != SFI1_LZCOMP) {
+            if (verbose) {
+                pline("File \"%s\" has incompatible LZCOMP compression.",
+                      name);
+                wait_synch();
+            }
+            return 2;
+        } else if ((sfrestinfo.sfi1 & SFI1_LZCOMP) != SFI1_LZCOMP) {
+            set_restpref("lzcomp");
+        }
+    }
+
     if ((sfi.sfi1 & SFI1_ZEROCOMP) == SFI1_ZEROCOMP) {
         if ((compatible & SFI1_ZEROCOMP) != SFI1_ZEROCOMP) {
             if (verbose) {
@@ -1446,12 +1579,47 @@ const char *name;
     else
         set_restpref("!rlecomp");
 
+    if ((sfi.sfi1 & SFI1_COLCOMP) == SFI1_COLCOMP) {
+        if ((compatible & SFI1_COLCOMP) != SFI1_COLCOMP) {
+            if (verbose) {
+                pline("File \"%s\" has incompatible column compression.",
+                      name);
+                wait_synch();
+            }
+            return 2;
+        } else if ((sfrestinfo.sfi1 & SFI1_COLCOMP) != SFI1_COLCOMP) {
+            set_restpref("colcomp");
+        }
+    } else {
+        set_restpref("!colcomp");
+    }
+
+    if ((sfi.sfi1 & SFI1_CRC32C) == SFI1_CRC32C) {
+        if ((compatible & SFI1_CRC32C) != SFI1_CRC32C) {
+            if (verbose) {
+                pline("File \"%s\" has checksums this game can't check.",
+                      name);
+                wait_synch();
+            }
+            return 2;
+        } else if ((sfrestinfo.sfi1 & SFI1_CRC32C) != SFI1_CRC32C) {
+            set_restpref("savecrc");
+        }
+    } else {
+        set_restpref("!savecrc");
+    }
+
     return 0;
 }
 
 void
 reset_restpref()
 {
+#ifdef LZCOMP
+    if (iflags.lzcomp)
+        set_restpref("lzcomp");
+    else
+#endif
 #ifdef ZEROCOMP
     if (iflags.zerocomp)
         set_restpref("zerocomp");
@@ -1464,6 +1632,18 @@ reset_restpref()
     else
 #endif
         set_restpref("!rlecomp");
+#ifdef COLCOMP
+    if (iflags.colcomp)
+        set_restpref("colcomp");
+    else
+#endif
+        set_restpref("!colcomp");
+#ifdef SAVECRC
+    if (iflags.savecrc)
+        set_restpref("savecrc");
+    else
+#endif
+        set_restpref("!savecrc");
 }
 
 void
@@ -1475,27 +1655,53 @@ const char *suitename;
         restoreprocs.restore_mread = def_mread;
         restoreprocs.restore_minit = def_minit;
         sfrestinfo.sfi1 |= SFI1_EXTERNALCOMP;
-        sfrestinfo.sfi1 &= ~SFI1_ZEROCOMP;
+        sfrestinfo.sfi1 &= ~(SFI1_ZEROCOMP | SFI1_LZCOMP);
         def_minit();
     }
     if (!strcmpi(suitename, "!rlecomp")) {
         sfrestinfo.sfi1 &= ~SFI1_RLECOMP;
     }
+    if (!strcmpi(suitename, "!colcomp")) {
+        sfrestinfo.sfi1 &= ~SFI1_COLCOMP;
+    }
+    if (!strcmpi(suitename, "!savecrc")) {
+        sfrestinfo.sfi1 &= ~SFI1_CRC32C;
+    }
 #ifdef ZEROCOMP
     if (!strcmpi(suitename, "zerocomp")) {
         restoreprocs.name = "zerocomp";
         restoreprocs.restore_mread = zerocomp_mread;
         restoreprocs.restore_minit = zerocomp_minit;
         sfrestinfo.sfi1 |= SFI1_ZEROCOMP;
-        sfrestinfo.sfi1 &= ~SFI1_EXTERNALCOMP;
+        sfrestinfo.sfi1 &= ~(SFI1_EXTERNALCOMP | SFI1_LZCOMP);
         zerocomp_minit();
     }
 #endif
+#ifdef LZCOMP
+    if (!strcmpi(suitename, "lzcomp")) {
+        restoreprocs.name = "lzcomp";
+        restoreprocs.restore_mread = lzcomp_mread;
+        restoreprocs.restore_minit = lzcomp_minit;
+        sfrestinfo.sfi1 |= SFI1_LZCOMP;
+        sfrestinfo.sfi1 &= ~(SFI1_EXTERNALCOMP | SFI1_ZEROCOMP);
+        lzcomp_minit();
+    }
+#endif
 #ifdef RLECOMP
     if (!strcmpi(suitename, "rlecomp")) {
         sfrestinfo.sfi1 |= SFI1_RLECOMP;
     }
 #endif
+#ifdef COLCOMP
+    if (!strcmpi(suitename, "colcomp")) {
+        sfrestinfo.sfi1 |= SFI1_COLCOMP;
+    }
+#endif
+#ifdef SAVECRC
+    if (!strcmpi(suitename, "savecrc")) {
+        sfrestinfo.sfi1 |= SFI1_CRC32C;
+    }
+#endif
 }
 
 #ifdef ZEROCOMP
@@ -1514,7 +1720,7 @@ STATIC_OVL int
 zerocomp_mgetc()
 {
     if (inbufp >= inbufsz) {
-        inbufsz = read(mreadfd, (genericptr_t) inbuf, sizeof inbuf);
+        inbufsz = nhread(mreadfd, (genericptr_t) inbuf, sizeof inbuf);
         if (!inbufsz) {
             if (inbufp > sizeof inbuf)
                 error("EOF on file #%d.\n", mreadfd);
@@ -1563,6 +1769,119 @@ register unsigned len;
 }
 #endif /* ZEROCOMP */
 
+#ifdef LZCOMP
+/* see the description of the format in save.c */
+#define LZ_BLOCKSIZ 32768
+#define LZ_MINMATCH 4
+
+static NEARDATA unsigned char lz_block[LZ_BLOCKSIZ];
+static NEARDATA unsigned char lz_packed[LZ_BLOCKSIZ];
+static NEARDATA unsigned lz_blocklen = 0, lz_blockpos = 0;
+
+STATIC_OVL void
+lzcomp_minit()
+{
+    lz_blocklen = lz_blockpos = 0;
+}
+
+/* read and expand the next block; FALSE if it's missing or damaged */
+STATIC_OVL boolean
+lzcomp_getblock(fd)
+int fd;
+{
+    unsigned char hdr[4];
+    unsigned len, clen, ip, op, n, off;
+    int b;
+
+    lz_blocklen = lz_blockpos = 0;
+    if (nhread(fd, (genericptr_t) hdr, sizeof hdr) != sizeof hdr)
+        return FALSE;
+    len = hdr[0] | (hdr[1] << 8);
+    clen = hdr[2] | (hdr[3] << 8);
+    if (!len || len > LZ_BLOCKSIZ || clen >= len)
+        return FALSE;
+    if (!clen) {
+        if ((unsigned) nhread(fd, (genericptr_t) lz_block, len) != len)
+            return FALSE;
+        lz_blocklen = len;
+        return TRUE;
+    }
+    if ((unsigned) nhread(fd, (genericptr_t) lz_packed, clen) != clen)
+        return FALSE;
+
+    for (ip = op = 0; ip < clen;) {
+        n = lz_packed[ip] >> 4;
+        b = lz_packed[ip++] & 15;
+        if (n == 15)
+            do {
+                if (ip >= clen)
+                    return FALSE;
+                n += lz_packed[ip];
+            } while (lz_packed[ip++] == 255);
+        if (n > clen - ip || n > len - op)
+            return FALSE;
+        (void) memcpy((genericptr_t) &lz_block[op],
+                      (genericptr_t) &lz_packed[ip], n);
+        ip += n, op += n;
+        if (ip == clen)
+            break; /* last sequence has no match */
+        if (clen - ip < 2)
+            return FALSE;
+        off = lz_packed[ip] | (lz_packed[ip + 1] << 8);
+        ip += 2;
+        n = (unsigned) b;
+        if (n == 15)
+            do {
+                if (ip >= clen)
+                    return FALSE;
+                n += lz_packed[ip];
+            } while (lz_packed[ip++] == 255);
+        n += LZ_MINMATCH;
+        if (!off || off > op || n > len - op)
+            return FALSE;
+        /* byte by byte, since the match may overlap what it's copying */
+        for (; n; n--, op++)
+            lz_block[op] = lz_block[op - off];
+    }
+    if (op != len)
+        return FALSE;
+    lz_blocklen = len;
+    return TRUE;
+}
+
+STATIC_OVL void
+lzcomp_mread(fd, buf, len)
+int fd;
+genericptr_t buf;
+register unsigned len;
+{
+    char *bp = (char *) buf;
+    unsigned n;
+
+    if (fd < 0)
+        error("Restore error; mread attempting to read file %d.", fd);
+    while (len) {
+        if (lz_blockpos >= lz_blocklen && !lzcomp_getblock(fd)) {
+            if (restoreprocs.mread_flags == 1) { /* means "return anyway" */
+                restoreprocs.mread_flags = -1;
+                return;
+            }
+            pline("Compressed data in file #%d is missing or damaged.", fd);
+            if (restoring) {
+                (void) nhclose(fd);
+                (void) delete_savefile();
+                error("Error restoring old game.");
+            }
+            panic("Error reading level file.");
+        }
+        n = min(len, lz_blocklen - lz_blockpos);
+        (void) memcpy((genericptr_t) bp, (genericptr_t) &lz_block[lz_blockpos],
+                      n);
+        lz_blockpos += n, bp += n, len -= n;
+    }
+}
+#endif /* LZCOMP */
+
 STATIC_OVL void
 def_minit()
 {
@@ -1582,7 +1901,7 @@ register unsigned int len;
 #define readLenType unsigned
 #endif
 
-    rlen = read(fd, buf, (readLenType) len);
+    rlen = nhread(fd, buf, (unsigned) len);
     if ((readLenType) rlen != (readLenType) len) {
         if (restoreprocs.mread_flags == 1) { /* means "return anyway" */
             restoreprocs.mread_flags = -1;
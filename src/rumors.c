@@ -26,6 +26,13 @@
  * the first true rumor plus the size of the true rumors matches the offset
  * of the first false rumor.  Likewise, the offset of the first false rumor
  * plus the size of the false rumors matches the offset for end-of-file.
+ * Between the header and the first true rumor is a table of hexadecimal
+ * offsets, one line for each true rumor, each false rumor, and end-of-file,
+ * which the uniform_text option uses to pick a rumor by number.
+ *
+ * The epitaph, engrave, and bogusmon files consist of a "do not edit" line,
+ * a decimal count N, a table of N+1 hexadecimal offsets in the same form
+ * (N lines of text and end-of-file), and the text.
  */
 
 /*      3.1     [now obsolete for rumors but still accurate for oracles]
@@ -42,6 +49,7 @@
  */
 
 STATIC_DCL void FDECL(init_rumors, (dlb *));
+STATIC_DCL long FDECL(text_lineoff, (dlb *, long, long, int));
 STATIC_DCL void FDECL(init_oracles, (dlb *));
 
 /* rumor size variables are signed so that value -1 can be used as a flag */
@@ -50,6 +58,9 @@ static long true_rumor_size = 0L, false_rumor_size;
 static unsigned long true_rumor_start, false_rumor_start;
 /* rumor end offsets are signed because they're compared with [dlb_]ftell() */
 static long true_rumor_end, false_rumor_end;
+/* offset table: number of rumors, and where the table is and its spacing */
+static int true_rumor_count, false_rumor_count;
+static long rumor_tbl_start, rumor_tbl_width;
 /* oracles are handled differently from rumors... */
 static int oracle_flg = 0; /* -1=>don't use, 0=>need init, 1=>init done */
 static unsigned oracle_cnt = 0;
@@ -60,27 +71,48 @@ init_rumors(fp)
 dlb *fp;
 {
     static const char rumors_header[] = "%d,%ld,%lx;%d,%ld,%lx;0,0,%lx\n";
-    int true_count, false_count; /* in file but not used here */
     unsigned long eof_offset;
     char line[BUFSZ];
 
     (void) dlb_fgets(line, sizeof line, fp); /* skip "don't edit" comment */
     (void) dlb_fgets(line, sizeof line, fp);
-    if (sscanf(line, rumors_header, &true_count, &true_rumor_size,
-               &true_rumor_start, &false_count, &false_rumor_size,
+    if (sscanf(line, rumors_header, &true_rumor_count, &true_rumor_size,
+               &true_rumor_start, &false_rumor_count, &false_rumor_size,
                &false_rumor_start, &eof_offset) == 7
         && true_rumor_size > 0L
-        && false_rumor_size > 0L) {
+        && false_rumor_size > 0L
+        && true_rumor_count > 0 && false_rumor_count > 0) {
         true_rumor_end = (long) true_rumor_start + true_rumor_size;
         /* assert( true_rumor_end == false_rumor_start ); */
         false_rumor_end = (long) false_rumor_start + false_rumor_size;
         /* assert( false_rumor_end == eof_offset ); */
+        /* the offset table follows; measure one line of it */
+        rumor_tbl_start = dlb_ftell(fp);
+        (void) dlb_fgets(line, sizeof line, fp);
+        rumor_tbl_width = dlb_ftell(fp) - rumor_tbl_start;
     } else {
         true_rumor_size = -1L; /* init failed */
         (void) dlb_fclose(fp);
     }
 }
 
+/* return the offset of line 'lineno' from a text file's offset table */
+STATIC_OVL long
+text_lineoff(fp, tbl_start, tbl_width, lineno)
+dlb *fp;
+long tbl_start, tbl_width;
+int lineno;
+{
+    char line[BUFSZ];
+    unsigned long offset = 0L;
+
+    if (dlb_fseek(fp, tbl_start + lineno * tbl_width, SEEK_SET) < 0
+        || !dlb_fgets(line, sizeof line, fp)
+        || sscanf(line, "%6lx", &offset) != 1)
+        impossible("bad line offset table");
+    return (long) offset;
+}
+
 /* exclude_cookie is a hack used because we sometimes want to get rumors in a
  * context where messages such as "You swallowed the fortune!" that refer to
  * cookies should not appear.  This has no effect for true rumors since none
@@ -94,6 +126,7 @@ boolean exclude_cookie;
 {
     dlb *rumors;
     long tidbit, beginning;
+    int lineno;
     char *endp, line[BUFSZ], xbuf[BUFSZ];
 
     rumor_buf[0] = '\0';
@@ -124,24 +157,40 @@ boolean exclude_cookie;
             case 2: /*(might let a bogus input arg sneak thru)*/
             case 1:
                 beginning = (long) true_rumor_start;
-                tidbit = Rand() % true_rumor_size;
+                /* byte offset into the true rumors, or rumor number */
+                tidbit = !iflags.uniform_text ? Rand() % true_rumor_size
+                                              : (long) rn2(true_rumor_count);
                 break;
             case 0: /* once here, 0 => false rather than "either"*/
             case -1:
                 beginning = (long) false_rumor_start;
-                tidbit = Rand() % false_rumor_size;
+                tidbit = !iflags.uniform_text ? Rand() % false_rumor_size
+                                              : (long) rn2(false_rumor_count);
                 break;
             default:
                 impossible("strange truth value for rumor");
                 return strcpy(rumor_buf, "Oops...");
             }
-            (void) dlb_fseek(rumors, beginning + tidbit, SEEK_SET);
-            (void) dlb_fgets(line, sizeof line, rumors);
-            if (!dlb_fgets(line, sizeof line, rumors)
-                || (adjtruth > 0 && dlb_ftell(rumors) > true_rumor_end)) {
-                /* reached end of rumors -- go back to beginning */
-                (void) dlb_fseek(rumors, beginning, SEEK_SET);
+            if (iflags.uniform_text) {
+                /* every rumor is equally likely; false ones follow the
+                   true ones in the offset table */
+                lineno = (int) tidbit + ((adjtruth > 0) ? 0
+                                                        : true_rumor_count);
+                (void) dlb_fseek(rumors,
+                                 text_lineoff(rumors, rumor_tbl_start,
+                                              rumor_tbl_width, lineno),
+                                 SEEK_SET);
+                (void) dlb_fgets(line, sizeof line, rumors);
+            } else {
+                (void) dlb_fseek(rumors, beginning + tidbit, SEEK_SET);
                 (void) dlb_fgets(line, sizeof line, rumors);
+                if (!dlb_fgets(line, sizeof line, rumors)
+                    || (adjtruth > 0
+                        && dlb_ftell(rumors) > true_rumor_end)) {
+                    /* reached end of rumors -- go back to beginning */
+                    (void) dlb_fseek(rumors, beginning, SEEK_SET);
+                    (void) dlb_fgets(line, sizeof line, rumors);
+                }
             }
             if ((endp = index(line, '\n')) != 0)
                 *endp = 0;
@@ -290,25 +339,40 @@ char *buf;
     fh = dlb_fopen(fname, "r");
 
     if (fh) {
-        /* TODO: cache sizetxt, starttxt, endtxt. maybe cache file contents?
-         */
-        long sizetxt = 0, starttxt = 0, endtxt = 0, tidbit = 0;
+        long sizetxt = 0, starttxt = 0, endtxt = 0, tidbit = 0,
+             tbl_start, tbl_width;
+        unsigned long first = 0L;
+        int cnt = 0;
         char *endp, line[BUFSZ], xbuf[BUFSZ];
         (void) dlb_fgets(line, sizeof line,
                          fh); /* skip "don't edit" comment */
-
-        (void) dlb_fseek(fh, 0L, SEEK_CUR);
-        starttxt = dlb_ftell(fh);
-        (void) dlb_fseek(fh, 0L, SEEK_END);
-        endtxt = dlb_ftell(fh);
-        sizetxt = endtxt - starttxt;
-        tidbit = Rand() % sizetxt;
-
-        (void) dlb_fseek(fh, starttxt + tidbit, SEEK_SET);
         (void) dlb_fgets(line, sizeof line, fh);
-        if (!dlb_fgets(line, sizeof line, fh)) {
-            (void) dlb_fseek(fh, starttxt, SEEK_SET);
+        (void) sscanf(line, "%5d", &cnt);
+        /* the first entry of the offset table is where the text starts */
+        tbl_start = dlb_ftell(fh);
+        (void) dlb_fgets(line, sizeof line, fh);
+        (void) sscanf(line, "%6lx", &first);
+        tbl_width = dlb_ftell(fh) - tbl_start;
+        starttxt = (long) first;
+
+        if (iflags.uniform_text && cnt > 0) {
+            /* every line is equally likely */
+            (void) dlb_fseek(fh, text_lineoff(fh, tbl_start, tbl_width,
+                                              rn2(cnt)),
+                             SEEK_SET);
+            (void) dlb_fgets(line, sizeof line, fh);
+        } else {
+            (void) dlb_fseek(fh, 0L, SEEK_END);
+            endtxt = dlb_ftell(fh);
+            sizetxt = endtxt - starttxt;
+            tidbit = Rand() % sizetxt;
+
+            (void) dlb_fseek(fh, starttxt + tidbit, SEEK_SET);
             (void) dlb_fgets(line, sizeof line, fh);
+            if (!dlb_fgets(line, sizeof line, fh)) {
+                (void) dlb_fseek(fh, starttxt, SEEK_SET);
+                (void) dlb_fgets(line, sizeof line, fh);
+            }
         }
         if ((endp = index(line, '\n')) != 0)
             *endp = 0;
@@ -30,6 +30,9 @@ STATIC_DCL void FDECL(savemon, (int, struct monst *));
 STATIC_DCL void FDECL(savemonchn, (int, struct monst *, int));
 STATIC_DCL void FDECL(savetrapchn, (int, struct trap *, int));
 STATIC_DCL void FDECL(savegamestate, (int, int));
+#ifdef INSURANCE
+STATIC_DCL void FDECL(savechkptstate, (int));
+#endif
 STATIC_OVL void FDECL(save_msghistory, (int, int));
 #ifdef MFLOPPY
 STATIC_DCL void FDECL(savelev0, (int, XCHAR_P, int));
@@ -37,6 +40,10 @@ STATIC_DCL boolean NDECL(swapout_oldest);
 STATIC_DCL void FDECL(copyfile, (char *, char *));
 #endif /* MFLOPPY */
 STATIC_DCL void FDECL(savelevl, (int fd, BOOLEAN_P));
+#ifdef COLCOMP
+STATIC_DCL void FDECL(savelevl_planes, (int));
+STATIC_DCL void FDECL(savelevl_plane, (int, int));
+#endif
 STATIC_DCL void FDECL(def_bufon, (int));
 STATIC_DCL void FDECL(def_bufoff, (int));
 STATIC_DCL void FDECL(def_bflush, (int));
@@ -48,6 +55,18 @@ STATIC_DCL void FDECL(zerocomp_bflush, (int));
 STATIC_DCL void FDECL(zerocomp_bwrite, (int, genericptr_t, unsigned int));
 STATIC_DCL void FDECL(zerocomp_bputc, (int));
 #endif
+#ifdef LZCOMP
+STATIC_DCL void FDECL(lzcomp_bufon, (int));
+STATIC_DCL void FDECL(lzcomp_bufoff, (int));
+STATIC_DCL void FDECL(lzcomp_bflush, (int));
+STATIC_DCL void FDECL(lzcomp_bwrite, (int, genericptr_t, unsigned int));
+STATIC_DCL void FDECL(lzcomp_bclose, (int));
+STATIC_DCL unsigned FDECL(lzcomp_squeeze, (unsigned char *, unsigned,
+                                           unsigned char *));
+#endif
+#ifdef SAVECRC
+STATIC_DCL void NDECL(crc_flush);
+#endif
 
 static struct save_procs {
     const char *name;
@@ -73,6 +92,11 @@ static struct save_procs {
 
 /* need to preserve these during save to avoid accessing freed memory */
 static unsigned ustuck_id = 0, usteed_id = 0;
+#ifdef INSURANCE
+/* asking the window port for the message history can disturb the message
+   window, so save_chkptdelta() leaves it out of what it writes */
+static boolean no_msghistory = FALSE;
+#endif
 
 int
 dosave()
@@ -123,6 +147,7 @@ dosave0()
 
     if (!program_state.something_worth_saving || !SAVEF[0])
         return 0;
+    chkpt_wait(); /* let any checkpoint in progress finish first */
     fq_save = fqname(SAVEF, SAVEPREFIX, 1); /* level files take 0 */
 
 #if defined(UNIX) || defined(VMS)
@@ -269,6 +294,7 @@ dosave0()
     delete_levelfile(ledger_no(&u.uz));
     delete_levelfile(0);
     nh_compress(fq_save);
+    update_save_catalog(TRUE);
     /* this should probably come sooner... */
     program_state.something_worth_saving = 0;
     return 1;
@@ -392,7 +418,7 @@ savestateinlock()
         if (tricked_fileremoved(fd, whynot))
             return;
 
-        (void) read(fd, (genericptr_t) &hpid, sizeof(hpid));
+        (void) nhread(fd, (genericptr_t) &hpid, sizeof(hpid));
         if (hackpid != hpid) {
             Sprintf(whynot, "Level #0 pid (%d) doesn't match ours (%d)!",
                     hpid, hackpid);
@@ -402,31 +428,72 @@ savestateinlock()
         }
         (void) nhclose(fd);
 
-        fd = create_levelfile(0, whynot);
+        fd = create_chkptfile(whynot);
         if (fd < 0) {
             pline1(whynot);
             Strcpy(killer.name, whynot);
             done(TRICKED);
             return;
         }
-        (void) write(fd, (genericptr_t) &hackpid, sizeof(hackpid));
-        if (flags.ins_chkpt) {
-            int currlev = ledger_no(&u.uz);
-
-            (void) write(fd, (genericptr_t) &currlev, sizeof(currlev));
-            save_savefile_name(fd);
-            store_version(fd);
-            store_savefileinfo(fd);
-            store_plname_in_file(fd);
-
-            ustuck_id = (u.ustuck ? u.ustuck->m_id : 0);
-            usteed_id = (u.usteed ? u.usteed->m_id : 0);
-            savegamestate(fd, WRITE_SAVE);
-        }
+        (void) nhwrite(fd, (genericptr_t) &hackpid, sizeof(hackpid));
+        if (flags.ins_chkpt)
+            savechkptstate(fd);
         bclose(fd);
     }
     havestate = flags.ins_chkpt;
 }
+
+/* the part of level 0 after the pid when checkpointing is on */
+STATIC_OVL void
+savechkptstate(fd)
+int fd;
+{
+    int currlev = ledger_no(&u.uz);
+
+    (void) nhwrite(fd, (genericptr_t) &currlev, sizeof(currlev));
+    save_savefile_name(fd);
+    store_version(fd);
+    store_savefileinfo(fd);
+    store_plname_in_file(fd);
+
+    ustuck_id = (u.ustuck ? u.ustuck->m_id : 0);
+    usteed_id = (u.usteed ? u.usteed->m_id : 0);
+    savegamestate(fd, WRITE_SAVE);
+}
+
+/* Between the checkpoints written when the hero changes levels, bring
+ * level 0 and the current level's file up to date every so many turns,
+ * as sysconf's CHECKPOINT_DELTAS says, by journaling what changed in
+ * them.  When the journal gets too big, they're written in full again.
+ */
+void
+save_chkptdelta()
+{
+    static long lastdelta = 0L;
+    int fd, currlev;
+
+    if (!flags.ins_chkpt || sysopt.chkptdeltas <= 0
+        || (moves >= lastdelta && moves - lastdelta < sysopt.chkptdeltas)
+        /* savelev() would purge dead monsters sooner than movemon() */
+        || iflags.purge_monsters)
+        return;
+    lastdelta = moves;
+    currlev = ledger_no(&u.uz);
+
+    no_msghistory = TRUE;
+    fd = create_scratchfile(0);
+    (void) nhwrite(fd, (genericptr_t) &hackpid, sizeof(hackpid));
+    savechkptstate(fd);
+    bclose(fd);
+    fd = create_scratchfile(1);
+    bufon(fd);
+    savelev(fd, currlev, WRITE_SAVE);
+    bclose(fd);
+
+    if (chkpt_delta(currlev, moves))
+        save_currentstate();
+    no_msghistory = FALSE;
+}
 #endif
 
 #ifdef MFLOPPY
@@ -503,8 +570,13 @@ int mode;
     bwrite(fd, (genericptr_t) &lev, sizeof(lev));
 #endif
     savecemetery(fd, mode, &level.bonesinfo);
-    savelevl(fd,
-             (boolean) ((sfsaveinfo.sfi1 & SFI1_RLECOMP) == SFI1_RLECOMP));
+#ifdef COLCOMP
+    if ((sfsaveinfo.sfi1 & SFI1_COLCOMP) == SFI1_COLCOMP)
+        savelevl_planes(fd);
+    else
+#endif
+        savelevl(fd, (boolean) ((sfsaveinfo.sfi1 & SFI1_RLECOMP)
+                                == SFI1_RLECOMP));
     bwrite(fd, (genericptr_t) lastseentyp, sizeof(lastseentyp));
     bwrite(fd, (genericptr_t) &monstermoves, sizeof(monstermoves));
     bwrite(fd, (genericptr_t) &upstair, sizeof(stairway));
@@ -548,6 +620,102 @@ skip_lots:
         bflush(fd);
 }
 
+#ifdef COLCOMP
+/* one field of every map location, and its encoding (see rm.h) */
+static int colvals[ROWNO * COLNO];
+static uchar colbuf[LP_MAXLEN];
+
+#define GET_PLANE(fld)              \
+    for (y = 0; y < ROWNO; y++)     \
+        for (x = 0; x < COLNO; x++) \
+            *v++ = (int) levl[x][y].fld
+
+STATIC_OVL void
+savelevl_plane(fd, plane)
+int fd, plane;
+{
+    register int *v = colvals;
+    uchar *p = colbuf;
+    int x, y, i, n, val, prev, delta;
+    unsigned len;
+
+    switch (plane) {
+    case LP_TYP:
+        GET_PLANE(typ);
+        break;
+    case LP_GLYPH:
+        GET_PLANE(glyph);
+        break;
+    case LP_SEENV:
+        GET_PLANE(seenv);
+        break;
+    case LP_FLAGS:
+        GET_PLANE(flags);
+        break;
+    case LP_HORIZONTAL:
+        GET_PLANE(horizontal);
+        break;
+    case LP_LIT:
+        GET_PLANE(lit);
+        break;
+    case LP_WASLIT:
+        GET_PLANE(waslit);
+        break;
+    case LP_ROOMNO:
+        GET_PLANE(roomno);
+        break;
+    case LP_EDGE:
+        GET_PLANE(edge);
+        break;
+    case LP_CANDIG:
+        GET_PLANE(candig);
+        break;
+    default:
+        panic("savelevl: bad plane %d", plane);
+    }
+
+    prev = 0;
+    for (i = 0; i < ROWNO * COLNO; i += n) {
+        val = colvals[i];
+        for (n = 1; n < 255 && i + n < ROWNO * COLNO; n++)
+            if (colvals[i + n] != val)
+                break;
+        *p++ = (uchar) n;
+        if (plane != LP_GLYPH) {
+            *p++ = (uchar) val;
+            continue;
+        }
+        delta = val - prev;
+        if (delta > -128 && delta < 128) {
+            *p++ = (uchar) (delta & 0xff);
+        } else {
+            *p++ = LP_ESC;
+            *p++ = (uchar) (val & 0xff);
+            *p++ = (uchar) ((val >> 8) & 0xff);
+            *p++ = (uchar) ((val >> 16) & 0xff);
+            *p++ = (uchar) ((val >> 24) & 0xff);
+        }
+        prev = val;
+    }
+    len = (unsigned) (p - colbuf);
+    bwrite(fd, (genericptr_t) &len, sizeof len);
+    bwrite(fd, (genericptr_t) colbuf, len);
+}
+
+#undef GET_PLANE
+
+/* write levl[][] out field by field; takes precedence over rlecomp */
+STATIC_OVL void
+savelevl_planes(fd)
+int fd;
+{
+    int plane;
+
+    for (plane = 0; plane < NUM_LEVL_PLANES; plane++)
+        savelevl_plane(fd, plane);
+}
+#endif /* COLCOMP */
+
 STATIC_OVL void
 savelevl(fd, rlecomp)
 int fd;
@@ -604,12 +772,57 @@ boolean rlecomp;
     bwrite(fd, (genericptr_t) levl, sizeof levl);
 }
 
+#ifdef SAVECRC
+/*
+ * Checksummed chunks.  When the savecrc option is on, what is written
+ * while buffering is on is gathered into chunks of up to CRC_CHUNKSIZ
+ * bytes.  Each one goes out as its length and its CRC-32C, four bytes
+ * each, low byte first, followed by the chunk itself.  This happens
+ * before any compression, so mread() can check a chunk as soon as it
+ * has been expanded and before any of it is used.  A chunk is ended
+ * whenever the output is flushed, so level files can still be glued
+ * together.
+ */
+#define CRC_CHUNKSIZ 16384
+#define CRC_HDRSIZ 8
+
+static NEARDATA unsigned char crc_chunk[CRC_CHUNKSIZ];
+static NEARDATA unsigned crc_chunklen = 0;
+static NEARDATA int crc_fd = -1;
+static NEARDATA boolean crc_chunking = FALSE;
+
+/* write out the current chunk */
+STATIC_OVL void
+crc_flush()
+{
+    unsigned char hdr[CRC_HDRSIZ];
+    unsigned long crc;
+    unsigned len = crc_chunklen;
+    int i;
+
+    if (!len)
+        return;
+    crc = crc32c(0L, (genericptr_t) crc_chunk, len);
+    for (i = 0; i < 4; i++) {
+        hdr[i] = (unsigned char) ((len >> (8 * i)) & 0xff);
+        hdr[4 + i] = (unsigned char) ((crc >> (8 * i)) & 0xff);
+    }
+    crc_chunklen = 0;
+    (*saveprocs.save_bwrite)(crc_fd, (genericptr_t) hdr, CRC_HDRSIZ);
+    (*saveprocs.save_bwrite)(crc_fd, (genericptr_t) crc_chunk, len);
+}
+#endif /* SAVECRC */
+
 /*ARGSUSED*/
 void
 bufon(fd)
 int fd;
 {
     (*saveprocs.save_bufon)(fd);
+#ifdef SAVECRC
+    if ((sfsaveinfo.sfi1 & SFI1_CRC32C) == SFI1_CRC32C)
+        crc_chunking = TRUE;
+#endif
     return;
 }
 
@@ -618,6 +831,10 @@ void
 bufoff(fd)
 int fd;
 {
+#ifdef SAVECRC
+    crc_flush();
+    crc_chunking = FALSE;
+#endif
     (*saveprocs.save_bufoff)(fd);
     return;
 }
@@ -627,6 +844,9 @@ void
 bflush(fd)
 register int fd;
 {
+#ifdef SAVECRC
+    crc_flush();
+#endif
     (*saveprocs.save_bflush)(fd);
     return;
 }
@@ -637,6 +857,25 @@ int fd;
 genericptr_t loc;
 register unsigned num;
 {
+#ifdef SAVECRC
+    unsigned char *bp = (unsigned char *) loc;
+    unsigned n;
+
+    if (crc_chunking) {
+        if (crc_chunklen && fd != crc_fd)
+            crc_flush();
+        crc_fd = fd;
+        while (num) {
+            n = min(num, CRC_CHUNKSIZ - crc_chunklen);
+            (void) memcpy((genericptr_t) &crc_chunk[crc_chunklen],
+                          (genericptr_t) bp, n);
+            crc_chunklen += n, bp += n, num -= n;
+            if (crc_chunklen == CRC_CHUNKSIZ)
+                crc_flush();
+        }
+        return;
+    }
+#endif
     (*saveprocs.save_bwrite)(fd, loc, num);
     return;
 }
@@ -645,6 +884,11 @@ void
 bclose(fd)
 int fd;
 {
+#ifdef SAVECRC
+    if (fd == crc_fd)
+        crc_flush();
+    crc_chunking = FALSE;
+#endif
     (*saveprocs.save_bclose)(fd);
     return;
 }
@@ -658,7 +902,8 @@ def_bufon(fd)
 int fd;
 {
 #ifdef UNIX
-    if (bw_fd != fd) {
+    /* the level store keeps its own buffer */
+    if (bw_fd != fd && !in_levelstore(fd)) {
         if (bw_fd >= 0)
             panic("double buffering unexpected");
         bw_fd = fd;
@@ -705,7 +950,7 @@ register unsigned num;
 #endif
 
 #ifdef UNIX
-    if (buffering) {
+    if (buffering && !in_levelstore(fd)) {
         if (fd != bw_fd)
             panic("unbuffered write to fd %d (!= %d)", fd, bw_fd);
 
@@ -713,12 +958,7 @@ register unsigned num;
     } else
 #endif /* UNIX */
     {
-        /* lint wants 3rd arg of write to be an int; lint -p an unsigned */
-#if defined(BSD) || defined(ULTRIX) || defined(WIN32) || defined(_MSC_VER)
-        failed = ((long) write(fd, loc, (int) num) != (long) num);
-#else /* e.g. SYSV, __TURBOC__ */
-        failed = ((long) write(fd, loc, num) != (long) num);
-#endif
+        failed = ((long) nhwrite(fd, loc, num) != (long) num);
     }
 
     if (failed) {
@@ -783,7 +1023,7 @@ int c;
         return;
 #endif
     if (outbufp >= sizeof outbuf) {
-        (void) write(bwritefd, outbuf, sizeof outbuf);
+        (void) nhwrite(bwritefd, outbuf, sizeof outbuf);
         outbufp = 0;
     }
     outbuf[outbufp++] = (unsigned char) c;
@@ -827,7 +1067,7 @@ register int fd;
 #endif
 
     if (outbufp) {
-        if (write(fd, outbuf, outbufp) != outbufp) {
+        if (nhwrite(fd, outbuf, outbufp) != outbufp) {
 #if defined(UNIX) || defined(VMS) || defined(__EMX__)
             if (program_state.done_hup)
                 nh_terminate(EXIT_FAILURE);
@@ -853,7 +1093,7 @@ register unsigned num;
         if (count_only)
             return;
 #endif
-        if ((unsigned) write(fd, loc, num) != num) {
+        if ((unsigned) nhwrite(fd, loc, num) != num) {
 #if defined(UNIX) || defined(VMS) || defined(__EMX__)
             if (program_state.done_hup)
                 nh_terminate(EXIT_FAILURE);
@@ -888,6 +1128,215 @@ int fd;
 }
 #endif /* ZEROCOMP */
 
+#ifdef LZCOMP
+/*
+ * Block compression.  While buffering is on, output is gathered into
+ * blocks of up to LZ_BLOCKSIZ bytes.  Each block is written as a four
+ * byte header, holding its length and its compressed length (low byte
+ * first), followed by the compressed data.  A block that doesn't shrink
+ * is written as is, with a compressed length of 0.  Like zero-comp's
+ * runs, blocks are flushed whenever a level or the game state has been
+ * written out, so level files can still be glued together.
+ *
+ * The compressed data is a series of sequences.  Each one is a token
+ * byte, some literal bytes, and a two byte offset back to a match.  The
+ * token's high nybble is the number of literals, and its low nybble is
+ * the match length less LZ_MINMATCH.  15 in either means more length
+ * bytes follow, each adding up to 255.  The last sequence in a block
+ * has literals only.
+ */
+#define LZ_BLOCKSIZ 32768
+#define LZ_MINMATCH 4
+#define LZ_LASTLITS 5 /* no match may start this close to the end */
+#define LZ_HASHBITS 12
+#define LZ_HASH(p) \
+    ((((unsigned long) (p)[0] | ((unsigned long) (p)[1] << 8)           \
+       | ((unsigned long) (p)[2] << 16) | ((unsigned long) (p)[3] << 24)) \
+      * 2654435761UL & 0xffffffffUL) >> (32 - LZ_HASHBITS))
+
+static NEARDATA unsigned char lz_inbuf[LZ_BLOCKSIZ];
+static NEARDATA unsigned char lz_outbuf[4 + LZ_BLOCKSIZ + LZ_BLOCKSIZ / 255
+                                        + 16];
+static NEARDATA unsigned lz_inlen = 0;
+static NEARDATA int lz_fd = -1;
+static NEARDATA boolean lz_compressing = FALSE;
+
+/* compress len bytes of src into dst; returns the compressed length */
+STATIC_OVL unsigned
+lzcomp_squeeze(src, len, dst)
+unsigned char *src, *dst;
+unsigned len;
+{
+    static unsigned short head[1 << LZ_HASHBITS]; /* last position + 1 */
+    unsigned ip = 0, anchor = 0, op = 0, ref, mlen, n, i;
+    unsigned char *token;
+
+    (void) memset((genericptr_t) head, 0, sizeof head);
+    while (ip + LZ_MINMATCH + LZ_LASTLITS <= len) {
+        i = (unsigned) LZ_HASH(&src[ip]);
+        ref = head[i];
+        head[i] = (unsigned short) (ip + 1);
+        if (!ref || memcmp((genericptr_t) &src[ref - 1],
+                           (genericptr_t) &src[ip], LZ_MINMATCH)) {
+            ip++;
+            continue;
+        }
+        ref--;
+        mlen = LZ_MINMATCH;
+        while (ip + mlen < len - LZ_LASTLITS
+               && src[ref + mlen] == src[ip + mlen])
+            mlen++;
+
+        token = &dst[op++];
+        n = ip - anchor;
+        if (n >= 15) {
+            *token = 15 << 4;
+            for (n -= 15; n >= 255; n -= 255)
+                dst[op++] = 255;
+            dst[op++] = (unsigned char) n;
+        } else {
+            *token = (unsigned char) (n << 4);
+        }
+        (void) memcpy((genericptr_t) &dst[op], (genericptr_t) &src[anchor],
+                      ip - anchor);
+        op += ip - anchor;
+        dst[op++] = (unsigned char) ((ip - ref) & 0xff);
+        dst[op++] = (unsigned char) ((ip - ref) >> 8);
+        n = mlen - LZ_MINMATCH;
+        if (n >= 15) {
+            *token |= 15;
+            for (n -= 15; n >= 255; n -= 255)
+                dst[op++] = 255;
+            dst[op++] = (unsigned char) n;
+        } else {
+            *token |= (unsigned char) n;
+        }
+
+        /* remember where the matched bytes were, too */
+        for (n = ip + 1, ip += mlen; n < ip; n++)
+            if (n + LZ_MINMATCH <= len)
+                head[LZ_HASH(&src[n])] = (unsigned short) (n + 1);
+        anchor = ip;
+        if (op >= len)
+            return op; /* not worth it */
+    }
+
+    /* the rest goes as literals */
+    token = &dst[op++];
+    n = len - anchor;
+    if (n >= 15) {
+        *token = 15 << 4;
+        for (n -= 15; n >= 255; n -= 255)
+            dst[op++] = 255;
+        dst[op++] = (unsigned char) n;
+    } else {
+        *token = (unsigned char) (n << 4);
+    }
+    (void) memcpy((genericptr_t) &dst[op], (genericptr_t) &src[anchor],
+                  len - anchor);
+    op += len - anchor;
+    return op;
+}
+
+/*ARGSUSED*/
+STATIC_OVL void
+lzcomp_bufon(fd)
+int fd;
+{
+    lz_compressing = TRUE;
+    return;
+}
+
+STATIC_OVL void
+lzcomp_bufoff(fd)
+int fd;
+{
+    lzcomp_bflush(fd);
+    lz_compressing = FALSE;
+    return;
+}
+
+/* write out the current block */
+STATIC_OVL void
+lzcomp_bflush(fd)
+int fd;
+{
+    unsigned clen, total;
+
+    if (!lz_inlen)
+        return;
+    if (fd != lz_fd)
+        panic("lzcomp: flushing file %d with data for file %d", fd, lz_fd);
+    clen = lzcomp_squeeze(lz_inbuf, lz_inlen, &lz_outbuf[4]);
+    if (clen >= lz_inlen) {
+        (void) memcpy((genericptr_t) &lz_outbuf[4], (genericptr_t) lz_inbuf,
+                      lz_inlen);
+        clen = 0;
+    }
+    lz_outbuf[0] = (unsigned char) (lz_inlen & 0xff);
+    lz_outbuf[1] = (unsigned char) (lz_inlen >> 8);
+    lz_outbuf[2] = (unsigned char) (clen & 0xff);
+    lz_outbuf[3] = (unsigned char) (clen >> 8);
+    total = 4 + (clen ? clen : lz_inlen);
+    lz_inlen = 0;
+    if ((unsigned) nhwrite(fd, (genericptr_t) lz_outbuf, total) != total) {
+#if defined(UNIX) || defined(VMS) || defined(__EMX__)
+        if (program_state.done_hup)
+            nh_terminate(EXIT_FAILURE);
+        else
+#endif
+            panic("cannot write %u bytes to file #%d", total, fd);
+    }
+}
+
+STATIC_OVL void
+lzcomp_bwrite(fd, loc, num)
+int fd;
+genericptr_t loc;
+register unsigned num;
+{
+    unsigned char *bp = (unsigned char *) loc;
+    unsigned n;
+
+#ifdef MFLOPPY
+    bytes_counted += num;
+    if (count_only)
+        return;
+#endif
+    if (!lz_compressing) {
+        if ((unsigned) nhwrite(fd, loc, num) != num) {
+#if defined(UNIX) || defined(VMS) || defined(__EMX__)
+            if (program_state.done_hup)
+                nh_terminate(EXIT_FAILURE);
+            else
+#endif
+                panic("cannot write %u bytes to file #%d", num, fd);
+        }
+        return;
+    }
+    if (lz_inlen && fd != lz_fd)
+        lzcomp_bflush(lz_fd);
+    lz_fd = fd;
+    while (num) {
+        n = min(num, LZ_BLOCKSIZ - lz_inlen);
+        (void) memcpy((genericptr_t) &lz_inbuf[lz_inlen], (genericptr_t) bp,
+                      n);
+        lz_inlen += n, bp += n, num -= n;
+        if (lz_inlen == LZ_BLOCKSIZ)
+            lzcomp_bflush(fd);
+    }
+}
+
+STATIC_OVL void
+lzcomp_bclose(fd)
+int fd;
+{
+    lzcomp_bufoff(fd);
+    (void) nhclose(fd);
+    return;
+}
+#endif /* LZCOMP */
+
 STATIC_OVL void
 savelevchn(fd, mode)
 register int fd, mode;
@@ -1185,8 +1634,10 @@ int mode;
         trap2 = trap->ntrap;
         if (perform_bwrite(mode))
             bwrite(fd, (genericptr_t) trap, sizeof (struct trap));
-        if (release_data(mode))
+        if (release_data(mode)) {
+            level.traps[trap->tx][trap->ty] = (struct trap *) 0;
             dealloc_trap(trap);
+        }
         trap = trap2;
     }
     if (perform_bwrite(mode))
@@ -1245,7 +1696,11 @@ int fd, mode;
 
     if (perform_bwrite(mode)) {
         /* ask window port for each message in sequence */
-        while ((msg = getmsghistory(init)) != 0) {
+        while (
+#ifdef INSURANCE
+               !no_msghistory &&
+#endif
+               (msg = getmsghistory(init)) != 0) {
             init = FALSE;
             msglen = strlen(msg);
             /* sanity: truncate if necessary (shouldn't happen);
@@ -1297,11 +1752,17 @@ const char *suitename;
         saveprocs.save_bwrite = def_bwrite;
         saveprocs.save_bclose = def_bclose;
         sfsaveinfo.sfi1 |= SFI1_EXTERNALCOMP;
-        sfsaveinfo.sfi1 &= ~SFI1_ZEROCOMP;
+        sfsaveinfo.sfi1 &= ~(SFI1_ZEROCOMP | SFI1_LZCOMP);
     }
     if (!strcmpi(suitename, "!rlecomp")) {
         sfsaveinfo.sfi1 &= ~SFI1_RLECOMP;
     }
+    if (!strcmpi(suitename, "!colcomp")) {
+        sfsaveinfo.sfi1 &= ~SFI1_COLCOMP;
+    }
+    if (!strcmpi(suitename, "!savecrc")) {
+        sfsaveinfo.sfi1 &= ~SFI1_CRC32C;
+    }
 #ifdef ZEROCOMP
     if (!strcmpi(suitename, "zerocomp")) {
         saveprocs.name = "zerocomp";
@@ -1311,7 +1772,19 @@ const char *suitename;
         saveprocs.save_bwrite = zerocomp_bwrite;
         saveprocs.save_bclose = zerocomp_bclose;
         sfsaveinfo.sfi1 |= SFI1_ZEROCOMP;
-        sfsaveinfo.sfi1 &= ~SFI1_EXTERNALCOMP;
+        sfsaveinfo.sfi1 &= ~(SFI1_EXTERNALCOMP | SFI1_LZCOMP);
+    }
+#endif
+#ifdef LZCOMP
+    if (!strcmpi(suitename, "lzcomp")) {
+        saveprocs.name = "lzcomp";
+        saveprocs.save_bufon = lzcomp_bufon;
+        saveprocs.save_bufoff = lzcomp_bufoff;
+        saveprocs.save_bflush = lzcomp_bflush;
+        saveprocs.save_bwrite = lzcomp_bwrite;
+        saveprocs.save_bclose = lzcomp_bclose;
+        sfsaveinfo.sfi1 |= SFI1_LZCOMP;
+        sfsaveinfo.sfi1 &= ~(SFI1_EXTERNALCOMP | SFI1_ZEROCOMP);
     }
 #endif
 #ifdef RLECOMP
@@ -1319,6 +1792,16 @@ const char *suitename;
         sfsaveinfo.sfi1 |= SFI1_RLECOMP;
     }
 #endif
+#ifdef COLCOMP
+    if (!strcmpi(suitename, "colcomp")) {
+        sfsaveinfo.sfi1 |= SFI1_COLCOMP;
+    }
+#endif
+#ifdef SAVECRC
+    if (!strcmpi(suitename, "savecrc")) {
+        sfsaveinfo.sfi1 |= SFI1_CRC32C;
+    }
+#endif
 }
 
 /* also called by prscore(); this probably belongs in dungeon.c... */
@@ -1342,6 +1825,7 @@ freedynamicdata()
     free_menu_coloring();
     free_invbuf();           /* let_to_name (invent.c) */
     free_youbuf();           /* You_buf,&c (pline.c) */
+    free_datakeys();         /* data.base key index (pager.c) */
     msgtype_free();
     tmp_at(DISP_FREEMEM, 0); /* temporary display effects */
 #ifdef FREE_ALL_MEMORY
@@ -1384,6 +1868,8 @@ freedynamicdata()
     freeobjchn(migrating_objs);
     freemonchn(migrating_mons);
     freemonchn(mydogs); /* ascension or dungeon escape */
+    idmap_empty(&obj_id_map);
+    idmap_empty(&mon_id_map);
     /* freelevchn();  --  [folded into free_dungeons()] */
     free_animals();
     free_oracles();
@@ -1391,6 +1877,7 @@ freedynamicdata()
     freenames();
     free_waterlevel();
     free_dungeons();
+    free_sp_lev_cache();
 
     /* some pointers in iflags */
     if (iflags.wc_font_map)
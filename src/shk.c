@@ -1932,31 +1932,48 @@ struct obj *
 find_oid(id)
 unsigned id;
 {
-    struct obj *obj;
-    struct monst *mon, *mmtmp[3];
-    int i;
-
-    /* first check various obj lists directly */
-    if ((obj = o_on(id, invent)) != 0)
-        return obj;
-    if ((obj = o_on(id, fobj)) != 0)
-        return obj;
-    if ((obj = o_on(id, level.buriedobjlist)) != 0)
-        return obj;
-    if ((obj = o_on(id, migrating_objs)) != 0)
-        return obj;
-
-    /* not found yet; check inventory for members of various monst lists */
-    mmtmp[0] = fmon;
-    mmtmp[1] = migrating_mons;
-    mmtmp[2] = mydogs; /* for use during level changes */
-    for (i = 0; i < 3; i++)
-        for (mon = mmtmp[i]; mon; mon = mon->nmon)
-            if ((obj = o_on(id, mon->minvent)) != 0)
-                return obj;
-
-    /* not found at all */
-    return (struct obj *) 0;
+    struct obj *obj, *topobj, *best = (struct obj *) 0;
+    anything *val;
+    int rank, bestrank = 0, cursor = -1;
+
+    /*
+     * obj_id_map holds every allocated object, so candidates need to be
+     * screened by where their outermost container is.  Should there be
+     * more than one, rank them in the order the lists used to be
+     * searched: invent, fobj, buried, migrating, then the inventories of
+     * monsters on fmon, migrating_mons and mydogs (the latter for use
+     * during level changes).
+     */
+    while ((val = idmap_next(&obj_id_map, id, &cursor)) != 0) {
+        obj = val->a_obj;
+        for (topobj = obj; topobj->where == OBJ_CONTAINED;
+             topobj = topobj->ocontainer)
+            continue;
+        switch (topobj->where) {
+        case OBJ_INVENT:
+            rank = 1;
+            break;
+        case OBJ_FLOOR:
+            rank = 2;
+            break;
+        case OBJ_BURIED:
+            rank = 3;
+            break;
+        case OBJ_MIGRATING:
+            rank = 4;
+            break;
+        case OBJ_MINVENT:
+            /* MCHAIN_NONE yields 0, leaving limbo monsters out */
+            rank = topobj->ocarry->mchain ? 4 + topobj->ocarry->mchain : 0;
+            break;
+        default: /* OBJ_FREE, OBJ_ONBILL */
+            rank = 0;
+            break;
+        }
+        if (rank && (!best || rank < bestrank))
+            best = obj, bestrank = rank;
+    }
+    return best;
 }
 
 /* Returns the price of an arbitrary item in the shop.
@@ -2661,6 +2678,7 @@ register struct monst *shkp;
             *otmp = *obj;
             otmp->oextra = (struct oextra *) 0;
             bp->bo_id = otmp->o_id = context.ident++;
+            index_obj_id(otmp);
             otmp->where = OBJ_FREE;
             otmp->quan = (bp->bquan -= obj->quan);
             otmp->owt = 0; /* superfluous */
@@ -30,6 +30,9 @@ STATIC_DCL void FDECL(splev_stack_push, (struct splevstack *,
 STATIC_DCL struct opvar *FDECL(splev_stack_pop, (struct splevstack *));
 STATIC_DCL struct splevstack *FDECL(splev_stack_reverse,
                                     (struct splevstack *));
+STATIC_DCL struct opvar *NDECL(opvar_alloc);
+STATIC_DCL void FDECL(opvar_release, (struct opvar *));
+STATIC_DCL void NDECL(opvar_blocks_done);
 STATIC_DCL struct opvar *FDECL(opvar_new_str, (char *));
 STATIC_DCL struct opvar *FDECL(opvar_new_int, (long));
 STATIC_DCL struct opvar *FDECL(opvar_new_coord, (int, int));
@@ -115,6 +118,7 @@ STATIC_DCL void FDECL(spo_trap, (struct sp_coder *));
 STATIC_DCL void FDECL(spo_gold, (struct sp_coder *));
 STATIC_DCL void FDECL(spo_corridor, (struct sp_coder *));
 STATIC_DCL void FDECL(selection_setpoint, (int, int, struct opvar *, XCHAR_P));
+STATIC_DCL int FDECL(selection_colcount, (unsigned long));
 STATIC_DCL struct opvar *FDECL(selection_not, (struct opvar *));
 STATIC_DCL struct opvar *FDECL(selection_logical_oper, (struct opvar *,
                                                      struct opvar *, CHAR_P));
@@ -254,12 +258,15 @@ struct splevstack *st;
                     break;
                 case SPOVAR_VARIABLE:
                 case SPOVAR_STRING:
-                case SPOVAR_SEL:
                     Free(st->stackdata[i]->vardata.str);
                     st->stackdata[i]->vardata.str = NULL;
                     break;
+                case SPOVAR_SEL:
+                    Free(st->stackdata[i]->vardata.sel);
+                    st->stackdata[i]->vardata.sel = NULL;
+                    break;
                 }
-                Free(st->stackdata[i]);
+                opvar_release(st->stackdata[i]);
                 st->stackdata[i] = NULL;
             }
         }
@@ -346,11 +353,96 @@ struct splevstack *st;
 #define OV_pop(x) (x = splev_stack_getdat_any(coder))
 #define OV_pop_typ(x, typ) (x = splev_stack_getdat(coder, typ))
 
+/*
+ * Selections are bitsets with one word per map column; bit y of word x
+ * is set when location <x,y> is selected.  Column words keep the
+ * column-major order in which selections have always been visited, so
+ * selection_iterate() and selection_rndcoord() see locations (and draw
+ * random numbers) in the same sequence as before.
+ */
+#if ROWNO >= 32
+#error "selections need ROWNO to fit in an unsigned long"
+#endif
+#define SEL_COLMASK ((1UL << ROWNO) - 1UL)
+#define SEL_SIZE (COLNO * sizeof (unsigned long))
+
+/*
+ * Every SPO_PUSH clones its operand and the consumer frees it again, so
+ * a level script churns through hundreds of opvars per level.  Rather
+ * than going to alloc() and free() for each one, carve them out of
+ * blocks and recycle released ones through a free list.  The blocks live
+ * as long as the decoded level programs do (see free_sp_lev_cache()).
+ */
+#define OPVAR_BLOCK 256
+
+union opvar_slot {
+    struct opvar ov;
+    union opvar_slot *next; /* while on opvar_freelist */
+};
+
+struct opvar_block {
+    struct opvar_block *next;
+    union opvar_slot slot[OPVAR_BLOCK];
+};
+
+static struct opvar_block *opvar_blocks = 0;
+static union opvar_slot *opvar_freelist = 0;
+static long opvars_inuse = 0L;
+
+STATIC_OVL struct opvar *
+opvar_alloc()
+{
+    union opvar_slot *sl;
+
+    if (!opvar_freelist) {
+        struct opvar_block *blk;
+        int i;
+
+        blk = (struct opvar_block *) alloc(sizeof (struct opvar_block));
+        blk->next = opvar_blocks;
+        opvar_blocks = blk;
+        for (i = OPVAR_BLOCK - 1; i >= 0; i--) {
+            blk->slot[i].next = opvar_freelist;
+            opvar_freelist = &blk->slot[i];
+        }
+    }
+    sl = opvar_freelist;
+    opvar_freelist = sl->next;
+    opvars_inuse++;
+    return &sl->ov;
+}
+
+STATIC_OVL void
+opvar_release(ov)
+struct opvar *ov;
+{
+    union opvar_slot *sl = (union opvar_slot *) ov;
+
+    sl->next = opvar_freelist;
+    opvar_freelist = sl;
+    opvars_inuse--;
+}
+
+/* give the opvar blocks back; only done at final cleanup, so any opvar
+   still held elsewhere (a getpos() filter, say) goes away with them */
+STATIC_OVL void
+opvar_blocks_done()
+{
+    struct opvar_block *blk;
+
+    while ((blk = opvar_blocks) != 0) {
+        opvar_blocks = blk->next;
+        free((genericptr_t) blk);
+    }
+    opvar_freelist = (union opvar_slot *) 0;
+    opvars_inuse = 0L;
+}
+
 struct opvar *
 opvar_new_str(s)
 char *s;
 {
-    struct opvar *tmpov = (struct opvar *) alloc(sizeof(struct opvar));
+    struct opvar *tmpov = opvar_alloc();
 
     tmpov->spovartyp = SPOVAR_STRING;
     if (s) {
@@ -368,7 +460,7 @@ struct opvar *
 opvar_new_int(i)
 long i;
 {
-    struct opvar *tmpov = (struct opvar *) alloc(sizeof(struct opvar));
+    struct opvar *tmpov = opvar_alloc();
 
     tmpov->spovartyp = SPOVAR_INT;
     tmpov->vardata.l = i;
@@ -379,7 +471,7 @@ struct opvar *
 opvar_new_coord(x, y)
 int x, y;
 {
-    struct opvar *tmpov = (struct opvar *) alloc(sizeof(struct opvar));
+    struct opvar *tmpov = opvar_alloc();
 
     tmpov->spovartyp = SPOVAR_COORD;
     tmpov->vardata.l = SP_COORD_PACK(x, y);
@@ -415,13 +507,15 @@ struct opvar *ov;
         break;
     case SPOVAR_VARIABLE:
     case SPOVAR_STRING:
-    case SPOVAR_SEL:
         Free(ov->vardata.str);
         break;
+    case SPOVAR_SEL:
+        Free(ov->vardata.sel);
+        break;
     default:
         impossible("Unknown opvar value type (%i)!", ov->spovartyp);
     }
-    Free(ov);
+    opvar_release(ov);
 }
 
 /*
@@ -450,7 +544,7 @@ struct opvar *ov;
 
     if (!ov)
         panic("no opvar to clone");
-    tmpov = (struct opvar *) alloc(sizeof(struct opvar));
+    tmpov = opvar_alloc();
     tmpov->spovartyp = ov->spovartyp;
     switch (ov->spovartyp) {
     case SPOVAR_COORD:
@@ -463,9 +557,13 @@ struct opvar *ov;
         break;
     case SPOVAR_VARIABLE:
     case SPOVAR_STRING:
-    case SPOVAR_SEL:
         tmpov->vardata.str = dupstr(ov->vardata.str);
         break;
+    case SPOVAR_SEL:
+        tmpov->vardata.sel = (unsigned long *) alloc(SEL_SIZE);
+        (void) memcpy((genericptr_t) tmpov->vardata.sel,
+                      (genericptr_t) ov->vardata.sel, SEL_SIZE);
+        break;
     default:
         impossible("Unknown push value type (%i)!", ov->spovartyp);
     }
@@ -2687,7 +2785,7 @@ sp_lev *lvl;
 
         if (opcode == SPO_PUSH) {
             int nsize;
-            struct opvar *ov = (struct opvar *) alloc(sizeof(struct opvar));
+            struct opvar *ov = opvar_alloc();
 
             opdat = ov;
             ov->spovartyp = SPO_NULL;
@@ -2718,7 +2816,13 @@ sp_lev *lvl;
                 if (nsize)
                     Fread(opd, 1, nsize, fd);
                 opd[nsize] = 0;
-                ov->vardata.str = opd;
+                if (ov->spovartyp == SPOVAR_SEL) {
+                    /* stored as a character map; convert to a bitset */
+                    opvar_release(ov);
+                    opdat = ov = selection_opvar(opd);
+                    Free(opd);
+                } else
+                    ov->vardata.str = opd;
                 break;
             }
             default:
@@ -3636,21 +3740,25 @@ struct sp_coder *coder;
     opvar_free(srcroom);
 }
 
+/* make a new, empty selection; if nbuf is given, it is a map in the old
+   ROWNO x COLNO character format (2 for a selected location, 1 if not) */
 struct opvar *
 selection_opvar(nbuf)
 char *nbuf;
 {
-    struct opvar *ov;
-    char buf[(COLNO * ROWNO) + 1];
+    struct opvar *ov = opvar_alloc();
 
-    if (!nbuf) {
-        (void) memset(buf, 1, sizeof(buf));
-        buf[(COLNO * ROWNO)] = '\0';
-        ov = opvar_new_str(buf);
-    } else {
-        ov = opvar_new_str(nbuf);
-    }
     ov->spovartyp = SPOVAR_SEL;
+    ov->vardata.sel = (unsigned long *) alloc(SEL_SIZE);
+    (void) memset((genericptr_t) ov->vardata.sel, 0, SEL_SIZE);
+    if (nbuf) {
+        int x, y, len = (int) strlen(nbuf);
+
+        for (y = 0; y < ROWNO; y++)
+            for (x = 0; x < COLNO; x++)
+                if (COLNO * y + x < len && nbuf[COLNO * y + x] - 1)
+                    ov->vardata.sel[x] |= 1UL << y;
+    }
     return ov;
 }
 
@@ -3664,7 +3772,7 @@ struct opvar *ov;
     if (x < 0 || y < 0 || x >= COLNO || y >= ROWNO)
         return 0;
 
-    return (ov->vardata.str[COLNO * y + x] - 1);
+    return (xchar) ((ov->vardata.sel[x] >> y) & 1UL);
 }
 
 void
@@ -3678,7 +3786,22 @@ xchar c;
     if (x < 0 || y < 0 || x >= COLNO || y >= ROWNO)
         return;
 
-    ov->vardata.str[COLNO * y + x] = (char) (c + 1);
+    if (c)
+        ov->vardata.sel[x] |= 1UL << y;
+    else
+        ov->vardata.sel[x] &= ~(1UL << y);
+}
+
+/* number of locations selected in one column */
+STATIC_OVL int
+selection_colcount(bits)
+unsigned long bits;
+{
+    /* only the low ROWNO bits can be set, so 32-bit arithmetic will do */
+    bits = bits - ((bits >> 1) & 0x55555555UL);
+    bits = (bits & 0x33333333UL) + ((bits >> 2) & 0x33333333UL);
+    bits = (bits + (bits >> 4)) & 0x0f0f0f0fUL;
+    return (int) (((bits * 0x01010101UL) >> 24) & 0xffUL);
 }
 
 struct opvar *
@@ -3686,16 +3809,14 @@ selection_not(s)
 struct opvar *s;
 {
     struct opvar *ov;
-    int x, y;
+    int x;
 
     ov = selection_opvar((char *) 0);
     if (!ov)
         return NULL;
 
     for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++)
-            if (!selection_getpoint(x, y, s))
-                selection_setpoint(x, y, ov, 1);
+        ov->vardata.sel[x] = ~s->vardata.sel[x] & SEL_COLMASK;
 
     return ov;
 }
@@ -3706,28 +3827,23 @@ struct opvar *s1, *s2;
 char oper;
 {
     struct opvar *ov;
-    int x, y;
+    int x;
 
     ov = selection_opvar((char *) 0);
     if (!ov)
         return NULL;
 
-    for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++) {
-            switch (oper) {
-            default:
-            case '|':
-                if (selection_getpoint(x, y, s1)
-                    || selection_getpoint(x, y, s2))
-                    selection_setpoint(x, y, ov, 1);
-                break;
-            case '&':
-                if (selection_getpoint(x, y, s1)
-                    && selection_getpoint(x, y, s2))
-                    selection_setpoint(x, y, ov, 1);
-                break;
-            }
-        }
+    switch (oper) {
+    default:
+    case '|':
+        for (x = 0; x < COLNO; x++)
+            ov->vardata.sel[x] = s1->vardata.sel[x] | s2->vardata.sel[x];
+        break;
+    case '&':
+        for (x = 0; x < COLNO; x++)
+            ov->vardata.sel[x] = s1->vardata.sel[x] & s2->vardata.sel[x];
+        break;
+    }
 
     return ov;
 }
@@ -3738,6 +3854,7 @@ struct opvar *ov;
 struct opvar *mc;
 {
     int x, y;
+    unsigned long bits;
     schar mapc;
     xchar lit;
     struct opvar *ret = selection_opvar((char *) 0);
@@ -3747,8 +3864,8 @@ struct opvar *mc;
     mapc = SP_MAPCHAR_TYP(OV_i(mc));
     lit = SP_MAPCHAR_LIT(OV_i(mc));
     for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++)
-            if (selection_getpoint(x, y, ov) && (levl[x][y].typ == mapc)) {
+        for (y = 0, bits = ov->vardata.sel[x]; bits; y++, bits >>= 1)
+            if ((bits & 1UL) && (levl[x][y].typ == mapc)) {
                 switch (lit) {
                 default:
                 case -2:
@@ -3773,13 +3890,14 @@ struct opvar *ov;
 int percent;
 {
     int x, y;
+    unsigned long bits;
 
     if (!ov)
         return;
     for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++)
-            if (selection_getpoint(x, y, ov) && (rn2(100) >= percent))
-                selection_setpoint(x, y, ov, 0);
+        for (y = 0, bits = ov->vardata.sel[x]; bits; y++, bits >>= 1)
+            if ((bits & 1UL) && (rn2(100) >= percent))
+                ov->vardata.sel[x] &= ~(1UL << y);
 }
 
 STATIC_OVL int
@@ -3789,27 +3907,33 @@ schar *x, *y;
 boolean removeit;
 {
     int idx = 0;
-    int c;
+    int c, n;
     int dx, dy;
+    unsigned long bits;
 
-    for (dx = 0; dx < COLNO; dx++)
-        for (dy = 0; dy < ROWNO; dy++)
-            if (isok(dx, dy) && selection_getpoint(dx, dy, ov))
-                idx++;
+    /* column 0 isn't part of the map (see isok()) */
+    for (dx = 1; dx < COLNO; dx++)
+        idx += selection_colcount(ov->vardata.sel[dx]);
 
     if (idx) {
         c = rn2(idx);
-        for (dx = 0; dx < COLNO; dx++)
-            for (dy = 0; dy < ROWNO; dy++)
-                if (isok(dx, dy) && selection_getpoint(dx, dy, ov)) {
-                    if (!c) {
-                        *x = dx;
-                        *y = dy;
-                        if (removeit) selection_setpoint(dx, dy, ov, 0);
-                        return 1;
-                    }
-                    c--;
-                }
+        for (dx = 1; dx < COLNO; dx++) {
+            bits = ov->vardata.sel[dx];
+            n = selection_colcount(bits);
+            if (c >= n) {
+                c -= n;
+                continue;
+            }
+            while (c--)
+                bits &= bits - 1; /* drop the lowest selected row */
+            for (dy = 0; !(bits & 1UL); dy++)
+                bits >>= 1;
+            *x = dx;
+            *y = dy;
+            if (removeit)
+                ov->vardata.sel[dx] &= ~(1UL << dy);
+            return 1;
+        }
     }
     *x = *y = -1;
     return 0;
@@ -3820,51 +3944,41 @@ selection_do_grow(ov, dir)
 struct opvar *ov;
 int dir;
 {
-    int x, y, c;
-    char tmp[COLNO][ROWNO];
+    int x;
+    unsigned long grown[COLNO], west, here, east;
 
-    if (ov->spovartyp != SPOVAR_SEL)
-        return;
     if (!ov)
         return;
+    if (ov->spovartyp != SPOVAR_SEL)
+        return;
 
-    (void) memset(tmp, 0, sizeof(tmp));
-
-    for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++) {
-            c = 0;
-            if ((dir & W_WEST) && (x > 0)
-                && (selection_getpoint(x - 1, y, ov)))
-                c++;
-            if ((dir & (W_WEST | W_NORTH)) && (x > 0) && (y > 0)
-                && (selection_getpoint(x - 1, y - 1, ov)))
-                c++;
-            if ((dir & W_NORTH) && (y > 0)
-                && (selection_getpoint(x, y - 1, ov)))
-                c++;
-            if ((dir & (W_NORTH | W_EAST)) && (y > 0) && (x < COLNO - 1)
-                && (selection_getpoint(x + 1, y - 1, ov)))
-                c++;
-            if ((dir & W_EAST) && (x < COLNO - 1)
-                && (selection_getpoint(x + 1, y, ov)))
-                c++;
-            if ((dir & (W_EAST | W_SOUTH)) && (x < COLNO - 1)
-                && (y < ROWNO - 1) && (selection_getpoint(x + 1, y + 1, ov)))
-                c++;
-            if ((dir & W_SOUTH) && (y < ROWNO - 1)
-                && (selection_getpoint(x, y + 1, ov)))
-                c++;
-            if ((dir & (W_SOUTH | W_WEST)) && (y < ROWNO - 1) && (x > 0)
-                && (selection_getpoint(x - 1, y + 1, ov)))
-                c++;
-            if (c)
-                tmp[x][y] = 1;
-        }
+    /* a location is added if any neighbor in one of the directions is
+       selected; within a column, north is the next lower bit */
+    for (x = 0; x < COLNO; x++) {
+        west = (x > 0) ? ov->vardata.sel[x - 1] : 0UL;
+        here = ov->vardata.sel[x];
+        east = (x < COLNO - 1) ? ov->vardata.sel[x + 1] : 0UL;
+        grown[x] = 0UL;
+        if (dir & W_WEST)
+            grown[x] |= west;
+        if (dir & (W_WEST | W_NORTH))
+            grown[x] |= west << 1;
+        if (dir & W_NORTH)
+            grown[x] |= here << 1;
+        if (dir & (W_NORTH | W_EAST))
+            grown[x] |= east << 1;
+        if (dir & W_EAST)
+            grown[x] |= east;
+        if (dir & (W_EAST | W_SOUTH))
+            grown[x] |= east >> 1;
+        if (dir & W_SOUTH)
+            grown[x] |= here >> 1;
+        if (dir & (W_SOUTH | W_WEST))
+            grown[x] |= west >> 1;
+    }
 
     for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++)
-            if (tmp[x][y])
-                selection_setpoint(x, y, ov, 1);
+        ov->vardata.sel[x] |= grown[x] & SEL_COLMASK;
 }
 
 STATIC_VAR int FDECL((*selection_flood_check_func), (int, int));
@@ -3899,8 +4013,6 @@ struct opvar *ov;
 int x, y;
 boolean diagonals;
 {
-    static const char nhFunc[] = "selection_floodfill";
-    struct opvar *tmp = selection_opvar((char *) 0);
 #define SEL_FLOOD_STACK (COLNO * ROWNO)
 #define SEL_FLOOD(nx, ny)                     \
     do {                                      \
@@ -3911,44 +4023,43 @@ boolean diagonals;
         } else                                \
             panic(floodfill_stack_overrun);   \
     } while (0)
-#define SEL_FLOOD_CHKDIR(mx,my,sel)                  \
+#define SEL_FLOOD_CHKDIR(mx,my)                      \
     if (isok((mx), (my))                             \
-        && (*selection_flood_check_func)((mx), (my)) \
-        && !selection_getpoint((mx), (my), (sel)))   \
+        && !(seen[(mx)] & (1UL << (my)))             \
+        && (*selection_flood_check_func)((mx), (my))) \
         SEL_FLOOD((mx), (my))
     static const char floodfill_stack_overrun[] = "floodfill stack overrun";
     int idx = 0;
     xchar dx[SEL_FLOOD_STACK];
     xchar dy[SEL_FLOOD_STACK];
+    unsigned long seen[COLNO];
 
-    if (selection_flood_check_func == NULL) {
-        opvar_free(tmp);
+    if (selection_flood_check_func == NULL)
         return;
-    }
+    (void) memset((genericptr_t) seen, 0, sizeof seen);
     SEL_FLOOD(x, y);
     do {
         idx--;
         x = dx[idx];
         y = dy[idx];
         if (isok(x, y)) {
-            selection_setpoint(x, y, ov, 1);
-            selection_setpoint(x, y, tmp, 1);
+            ov->vardata.sel[x] |= 1UL << y;
+            seen[x] |= 1UL << y;
         }
-        SEL_FLOOD_CHKDIR((x + 1), y, tmp);
-        SEL_FLOOD_CHKDIR((x - 1), y, tmp);
-        SEL_FLOOD_CHKDIR(x, (y + 1), tmp);
-        SEL_FLOOD_CHKDIR(x, (y - 1), tmp);
+        SEL_FLOOD_CHKDIR((x + 1), y);
+        SEL_FLOOD_CHKDIR((x - 1), y);
+        SEL_FLOOD_CHKDIR(x, (y + 1));
+        SEL_FLOOD_CHKDIR(x, (y - 1));
         if (diagonals) {
-            SEL_FLOOD_CHKDIR((x + 1), (y + 1), tmp);
-            SEL_FLOOD_CHKDIR((x - 1), (y - 1), tmp);
-            SEL_FLOOD_CHKDIR((x - 1), (y + 1), tmp);
-            SEL_FLOOD_CHKDIR((x + 1), (y - 1), tmp);
+            SEL_FLOOD_CHKDIR((x + 1), (y + 1));
+            SEL_FLOOD_CHKDIR((x - 1), (y - 1));
+            SEL_FLOOD_CHKDIR((x - 1), (y + 1));
+            SEL_FLOOD_CHKDIR((x + 1), (y - 1));
         }
     } while (idx > 0);
 #undef SEL_FLOOD
 #undef SEL_FLOOD_STACK
 #undef SEL_FLOOD_CHKDIR
-    opvar_free(tmp);
 }
 
 /* McIlroy's Ellipse Algorithm */
@@ -4218,11 +4329,13 @@ select_iter_func func;
 genericptr_t arg;
 {
     int x, y;
+    unsigned long bits;
 
-    /* yes, this is very naive, but it's not _that_ expensive. */
+    if (!ov || ov->spovartyp != SPOVAR_SEL)
+        return;
     for (x = 0; x < COLNO; x++)
-        for (y = 0; y < ROWNO; y++)
-            if (selection_getpoint(x, y, ov))
+        for (y = 0, bits = ov->vardata.sel[x]; bits; y++, bits >>= 1)
+            if (bits & 1UL)
                 (*func)(x, y, arg);
 }
 
@@ -5796,10 +5909,12 @@ sp_lev *lvl;
                     selection_setpoint(x1, y, pt, 1);
                     selection_setpoint(x2, y, pt, 1);
                 }
-            } else {
-                for (x = x1; x <= x2; x++)
-                    for (y = y1; y <= y2; y++)
-                        selection_setpoint(x, y, pt, 1);
+            } else if (y1 <= y2) {
+                unsigned long rows = (SEL_COLMASK >> (ROWNO - 1 - y2))
+                                     & ~((1UL << y1) - 1UL);
+
+                for (x = x1; x <= x2 && x < COLNO; x++)
+                    pt->vardata.sel[x] |= rows;
             }
             splev_stack_push(coder->stack, pt);
             opvar_free(tmp);
@@ -5998,6 +6113,21 @@ sp_lev *lvl;
     return TRUE;
 }
 
+/*
+ * Decoded special level programs, kept for the life of the process.
+ * sp_level_coder() never modifies the program it runs (SPO_PUSH pushes
+ * a clone of its operand), so each level file only has to be read and
+ * decoded the first time it is used; after that, creating the level
+ * again -- whether in this game or a later one run by the same process --
+ * goes straight to the coder.
+ */
+struct sp_lev_cache {
+    struct sp_lev_cache *next;
+    char *name;
+    sp_lev *lvl;
+};
+static struct sp_lev_cache *sp_lev_cache = 0;
+
 /*
  * General loader
  */
@@ -6009,6 +6139,11 @@ const char *name;
     sp_lev *lvl = NULL;
     boolean result = FALSE;
     struct version_info vers_info;
+    struct sp_lev_cache *lc;
+
+    for (lc = sp_lev_cache; lc; lc = lc->next)
+        if (!strcmp(lc->name, name))
+            return sp_level_coder(lc->lvl);
 
     fd = dlb_fopen(name, RDBMODE);
     if (!fd)
@@ -6022,15 +6157,39 @@ const char *name;
     lvl = (sp_lev *) alloc(sizeof (sp_lev));
     result = sp_level_loader(fd, lvl);
     (void) dlb_fclose(fd);
-    if (result)
+    if (result) {
+        lc = (struct sp_lev_cache *) alloc(sizeof (struct sp_lev_cache));
+        lc->name = dupstr(name);
+        lc->lvl = lvl;
+        lc->next = sp_lev_cache;
+        sp_lev_cache = lc;
         result = sp_level_coder(lvl);
-    sp_level_free(lvl);
-    Free(lvl);
+    } else {
+        sp_level_free(lvl);
+        Free(lvl);
+    }
 
 give_up:
     return result;
 }
 
+/* release the decoded special level programs kept by load_special(),
+   along with the opvar blocks */
+void
+free_sp_lev_cache()
+{
+    struct sp_lev_cache *lc;
+
+    while ((lc = sp_lev_cache) != 0) {
+        sp_lev_cache = lc->next;
+        (void) sp_level_free(lc->lvl);
+        Free(lc->lvl);
+        Free(lc->name);
+        Free(lc);
+    }
+    opvar_blocks_done();
+}
+
 #ifdef _MSC_VER
  #pragma warning(pop)
 #endif
@@ -1507,8 +1507,9 @@ do_storms()
  *      Start a timer of kind 'kind' that will expire at time
  *      monstermoves+'timeout'.  Call the function at 'func_index'
  *      in the timeout table using argument 'arg'.  Return TRUE if
- *      a timer was started.  This places the timer on a list ordered
- *      "sooner" to "later".  If an object, increment the object's
+ *      a timer was started.  This places the timer in a queue ordered
+ *      "sooner" to "later"; timers due at the same time go off most
+ *      recently started first.  If an object, increment the object's
  *      timer count.
  *
  *  long stop_timer(short func_index, anything *arg)
@@ -1551,21 +1552,46 @@ do_storms()
  *
  *  boolean obj_has_timer(struct obj *object, short timer_type)
  *      Check whether object has a timer of type timer_type.
+ *
+ * Implementation:
+ *  The active timers are kept in a binary heap, timer_heap[], ordered
+ *  by timeout and then by reverse insertion order, which reproduces the
+ *  run order of the sorted list that used to hold them.  Each timer also
+ *  sits on a hash chain keyed by its argument so that the per-object and
+ *  per-spot operations don't need to look at every timer.  Routines that
+ *  care about queue order (save, #timeout display) sort a copy of the
+ *  heap.
  */
 
 STATIC_DCL const char *FDECL(kind_name, (SHORT_P));
-STATIC_DCL void FDECL(print_queue, (winid, timer_element *));
+STATIC_DCL void FDECL(print_queue, (winid));
+STATIC_DCL boolean FDECL(timer_before, (timer_element *, timer_element *));
+STATIC_DCL int FDECL(CFDECLSPEC timer_cmp, (const genericptr,
+                                            const genericptr));
+STATIC_DCL timer_element **FDECL(sorted_timers, (int *));
+STATIC_DCL void FDECL(heap_place, (timer_element *, int));
+STATIC_DCL void FDECL(heap_sift_up, (int));
+STATIC_DCL void FDECL(heap_sift_down, (int));
+STATIC_DCL unsigned FDECL(timer_hashval, (anything *));
+STATIC_DCL void FDECL(hash_timer, (timer_element *));
+STATIC_DCL void FDECL(unhash_timer, (timer_element *));
 STATIC_DCL void FDECL(insert_timer, (timer_element *));
-STATIC_DCL timer_element *FDECL(remove_timer,
-                                (timer_element **, SHORT_P, ANY_P *));
+STATIC_DCL void FDECL(unlink_timer, (timer_element *));
+STATIC_DCL timer_element *FDECL(remove_timer, (SHORT_P, ANY_P *));
 STATIC_DCL void FDECL(write_timer, (int, timer_element *));
 STATIC_DCL boolean FDECL(mon_is_local, (struct monst *));
 STATIC_DCL boolean FDECL(timer_is_local, (timer_element *));
 STATIC_DCL int FDECL(maybe_write_timer, (int, int, BOOLEAN_P));
 
-/* ordered timer list */
-static timer_element *timer_base; /* "active" */
+/* timer priority queue; timer_heap[0] is the next one to go off */
+static timer_element **timer_heap = 0; /* "active" */
+static int timer_heap_cnt = 0, timer_heap_siz = 0;
 static unsigned long timer_id = 1;
+static unsigned long timer_seq = 0; /* not saved; only order matters */
+
+/* active timers hashed by argument (object, monster, or spot) */
+#define TIMER_HASH_SIZE 1021
+static timer_element *timer_hash[TIMER_HASH_SIZE];
 
 /* If defined, then include names when printing out the timer queue */
 #define VERBOSE_TIMER
@@ -1616,18 +1642,20 @@ short kind;
 }
 
 STATIC_OVL void
-print_queue(win, base)
+print_queue(win)
 winid win;
-timer_element *base;
 {
-    timer_element *curr;
+    timer_element *curr, **queue;
     char buf[BUFSZ];
+    int i, count;
 
-    if (!base) {
+    if (!timer_heap_cnt) {
         putstr(win, 0, " <empty>");
     } else {
+        queue = sorted_timers(&count);
         putstr(win, 0, "timeout  id   kind   call");
-        for (curr = base; curr; curr = curr->next) {
+        for (i = 0; i < count; i++) {
+            curr = queue[i];
 #ifdef VERBOSE_TIMER
             Sprintf(buf, " %4ld   %4ld  %-6s %s(%s)", curr->timeout,
                     curr->tid, kind_name(curr->kind),
@@ -1640,6 +1668,7 @@ timer_element *base;
 #endif
             putstr(win, 0, buf);
         }
+        free((genericptr_t) queue);
     }
 }
 
@@ -1661,7 +1690,7 @@ wiz_timeout_queue()
     putstr(win, 0, "");
     putstr(win, 0, "Active timeout queue:");
     putstr(win, 0, "");
-    print_queue(win, timer_base);
+    print_queue(win);
 
     /* Timed properies:
      * check every one; the majority can't obtain temporary timeouts in
@@ -1712,10 +1741,22 @@ wiz_timeout_queue()
 void
 timer_sanity_check()
 {
-    timer_element *curr;
+    timer_element *curr, *te;
+    int i;
 
     /* this should be much more complete */
-    for (curr = timer_base; curr; curr = curr->next)
+    for (i = 0; i < timer_heap_cnt; i++) {
+        curr = timer_heap[i];
+        if (curr->heapidx != i)
+            pline("timer sanity: timer %ld at %d thinks it is at %d",
+                  curr->tid, i, curr->heapidx);
+        if (i > 0 && timer_before(curr, timer_heap[(i - 1) / 2]))
+            pline("timer sanity: timer %ld out of order", curr->tid);
+        for (te = timer_hash[timer_hashval(&curr->arg)]; te; te = te->next)
+            if (te == curr)
+                break;
+        if (!te)
+            pline("timer sanity: timer %ld not hashed", curr->tid);
         if (curr->kind == TIMER_OBJECT) {
             struct obj *obj = curr->arg.a_obj;
 
@@ -1724,6 +1765,7 @@ timer_sanity_check()
                       fmt_ptr((genericptr_t) obj), curr->tid);
             }
         }
+    }
 }
 
 /*
@@ -1737,12 +1779,12 @@ run_timers()
 
     /*
      * Always use the first element.  Elements may be added or deleted at
-     * any time.  The list is ordered, we are done when the first element
+     * any time.  The queue is ordered, we are done when the first element
      * is in the future.
      */
-    while (timer_base && timer_base->timeout <= monstermoves) {
-        curr = timer_base;
-        timer_base = curr->next;
+    while (timer_heap_cnt && timer_heap[0]->timeout <= monstermoves) {
+        curr = timer_heap[0];
+        unlink_timer(curr);
 
         if (curr->kind == TIMER_OBJECT)
             (curr->arg.a_obj)->timed--;
@@ -1768,7 +1810,6 @@ anything *arg;
 
     gnu = (timer_element *) alloc(sizeof(timer_element));
     (void) memset((genericptr_t)gnu, 0, sizeof(timer_element));
-    gnu->next = 0;
     gnu->tid = timer_id++;
     gnu->timeout = monstermoves + when;
     gnu->kind = kind;
@@ -1796,7 +1837,7 @@ anything *arg;
     timer_element *doomed;
     long timeout;
 
-    doomed = remove_timer(&timer_base, func_index, arg);
+    doomed = remove_timer(func_index, arg);
 
     if (doomed) {
         timeout = doomed->timeout;
@@ -1820,7 +1861,7 @@ anything *arg;
 {
     timer_element *curr;
 
-    for (curr = timer_base; curr; curr = curr->next) {
+    for (curr = timer_hash[timer_hashval(arg)]; curr; curr = curr->next) {
         if (curr->func_index == type && curr->arg.a_void == arg->a_void)
             return curr->timeout;
     }
@@ -1834,15 +1875,28 @@ void
 obj_move_timers(src, dest)
 struct obj *src, *dest;
 {
-    int count;
-    timer_element *curr;
+    int count = 0;
+    timer_element *curr, *next_timer, *moved = 0;
+    anything key;
 
-    for (count = 0, curr = timer_base; curr; curr = curr->next)
+    /* pull src's timers off their hash chain, then rehash them for dest */
+    key = zeroany;
+    key.a_obj = src;
+    for (curr = timer_hash[timer_hashval(&key)]; curr; curr = next_timer) {
+        next_timer = curr->next;
         if (curr->kind == TIMER_OBJECT && curr->arg.a_obj == src) {
-            curr->arg.a_obj = dest;
-            dest->timed++;
-            count++;
+            unhash_timer(curr);
+            curr->next = moved;
+            moved = curr;
         }
+    }
+    while ((curr = moved) != 0) {
+        moved = curr->next;
+        curr->arg.a_obj = dest;
+        hash_timer(curr);
+        dest->timed++;
+        count++;
+    }
     if (count != src->timed)
         panic("obj_move_timers");
     src->timed = 0;
@@ -1855,15 +1909,26 @@ void
 obj_split_timers(src, dest)
 struct obj *src, *dest;
 {
-    timer_element *curr, *next_timer = 0;
+    timer_element *curr, **split;
+    anything key;
+    int i, count = 0;
 
-    for (curr = timer_base; curr; curr = next_timer) {
-        next_timer = curr->next; /* things may be inserted */
-        if (curr->kind == TIMER_OBJECT && curr->arg.a_obj == src) {
-            (void) start_timer(curr->timeout - monstermoves, TIMER_OBJECT,
-                               curr->func_index, obj_to_any(dest));
-        }
-    }
+    if (!src->timed)
+        return;
+    /* collect src's timers first since things will be inserted; start
+       the copies in queue order so that ties among them sort the same */
+    split = (timer_element **) alloc(src->timed * sizeof *split);
+    key = zeroany;
+    key.a_obj = src;
+    for (curr = timer_hash[timer_hashval(&key)]; curr; curr = curr->next)
+        if (curr->kind == TIMER_OBJECT && curr->arg.a_obj == src
+            && count < src->timed)
+            split[count++] = curr;
+    qsort((genericptr_t) split, count, sizeof *split, timer_cmp);
+    for (i = 0; i < count; i++)
+        (void) start_timer(split[i]->timeout - monstermoves, TIMER_OBJECT,
+                           split[i]->func_index, obj_to_any(dest));
+    free((genericptr_t) split);
 }
 
 /*
@@ -1874,21 +1939,19 @@ void
 obj_stop_timers(obj)
 struct obj *obj;
 {
-    timer_element *curr, *prev, *next_timer = 0;
+    timer_element *curr, *next_timer = 0;
+    anything key;
 
-    for (prev = 0, curr = timer_base; curr; curr = next_timer) {
+    key = zeroany;
+    key.a_obj = obj;
+    for (curr = timer_hash[timer_hashval(&key)]; curr; curr = next_timer) {
         next_timer = curr->next;
         if (curr->kind == TIMER_OBJECT && curr->arg.a_obj == obj) {
-            if (prev)
-                prev->next = curr->next;
-            else
-                timer_base = curr->next;
+            unlink_timer(curr);
             if (timeout_funcs[curr->func_index].cleanup)
                 (*timeout_funcs[curr->func_index].cleanup)(&curr->arg,
                                                            curr->timeout);
             free((genericptr_t) curr);
-        } else {
-            prev = curr;
         }
     }
     obj->timed = 0;
@@ -1916,23 +1979,21 @@ spot_stop_timers(x, y, func_index)
 xchar x, y;
 short func_index;
 {
-    timer_element *curr, *prev, *next_timer = 0;
+    timer_element *curr, *next_timer = 0;
     long where = (((long) x << 16) | ((long) y));
+    anything key;
 
-    for (prev = 0, curr = timer_base; curr; curr = next_timer) {
+    key = zeroany;
+    key.a_long = where;
+    for (curr = timer_hash[timer_hashval(&key)]; curr; curr = next_timer) {
         next_timer = curr->next;
         if (curr->kind == TIMER_LEVEL && curr->func_index == func_index
             && curr->arg.a_long == where) {
-            if (prev)
-                prev->next = curr->next;
-            else
-                timer_base = curr->next;
+            unlink_timer(curr);
             if (timeout_funcs[curr->func_index].cleanup)
                 (*timeout_funcs[curr->func_index].cleanup)(&curr->arg,
                                                            curr->timeout);
             free((genericptr_t) curr);
-        } else {
-            prev = curr;
         }
     }
 }
@@ -1948,8 +2009,11 @@ short func_index;
 {
     timer_element *curr;
     long where = (((long) x << 16) | ((long) y));
+    anything key;
 
-    for (curr = timer_base; curr; curr = curr->next) {
+    key = zeroany;
+    key.a_long = where;
+    for (curr = timer_hash[timer_hashval(&key)]; curr; curr = curr->next) {
         if (curr->kind == TIMER_LEVEL && curr->func_index == func_index
             && curr->arg.a_long == where)
             return curr->timeout;
@@ -1966,42 +2030,192 @@ short func_index;
     return (expires > 0L) ? expires - monstermoves : 0L;
 }
 
+/*
+ * Queue order: earlier timeout first; for equal timeouts, the one
+ * inserted most recently goes first.
+ */
+STATIC_OVL boolean
+timer_before(a, b)
+timer_element *a, *b;
+{
+    if (a->timeout != b->timeout)
+        return (boolean) (a->timeout < b->timeout);
+    return (boolean) (a->seq > b->seq);
+}
+
+/* qsort comparison routine for putting timers into queue order */
+STATIC_OVL int CFDECLSPEC
+timer_cmp(vptr1, vptr2)
+const genericptr vptr1;
+const genericptr vptr2;
+{
+    timer_element *a = *(timer_element **) vptr1,
+                  *b = *(timer_element **) vptr2;
+
+    return timer_before(a, b) ? -1 : timer_before(b, a) ? 1 : 0;
+}
+
+/* return a freshly allocated copy of the queue in the order it will run */
+STATIC_OVL timer_element **
+sorted_timers(countp)
+int *countp;
+{
+    timer_element **queue;
+
+    *countp = timer_heap_cnt;
+    queue = (timer_element **) alloc((timer_heap_cnt ? timer_heap_cnt : 1)
+                                     * sizeof *queue);
+    if (timer_heap_cnt) {
+        (void) memcpy((genericptr_t) queue, (genericptr_t) timer_heap,
+                      timer_heap_cnt * sizeof *queue);
+        qsort((genericptr_t) queue, timer_heap_cnt, sizeof *queue,
+              timer_cmp);
+    }
+    return queue;
+}
+
+STATIC_OVL void
+heap_place(te, idx)
+timer_element *te;
+int idx;
+{
+    timer_heap[idx] = te;
+    te->heapidx = idx;
+}
+
+STATIC_OVL void
+heap_sift_up(idx)
+int idx;
+{
+    timer_element *te = timer_heap[idx];
+    int parent;
+
+    while (idx > 0) {
+        parent = (idx - 1) / 2;
+        if (!timer_before(te, timer_heap[parent]))
+            break;
+        heap_place(timer_heap[parent], idx);
+        idx = parent;
+    }
+    heap_place(te, idx);
+}
+
+STATIC_OVL void
+heap_sift_down(idx)
+int idx;
+{
+    timer_element *te = timer_heap[idx];
+    int child;
+
+    while ((child = 2 * idx + 1) < timer_heap_cnt) {
+        if (child + 1 < timer_heap_cnt
+            && timer_before(timer_heap[child + 1], timer_heap[child]))
+            child++;
+        if (!timer_before(timer_heap[child], te))
+            break;
+        heap_place(timer_heap[child], idx);
+        idx = child;
+    }
+    heap_place(te, idx);
+}
+
+STATIC_OVL unsigned
+timer_hashval(arg)
+anything *arg;
+{
+    const unsigned char *p = (const unsigned char *) arg;
+    unsigned hash = 0;
+    int i;
+
+    /* the *_to_any() routines clear the unused bytes of the union */
+    for (i = 0; i < (int) sizeof (anything); i++)
+        hash = (hash * 31) + p[i];
+    return hash % TIMER_HASH_SIZE;
+}
+
+STATIC_OVL void
+hash_timer(te)
+timer_element *te;
+{
+    unsigned hash = timer_hashval(&te->arg);
+
+    te->next = timer_hash[hash];
+    timer_hash[hash] = te;
+}
+
+STATIC_OVL void
+unhash_timer(te)
+timer_element *te;
+{
+    timer_element **prevp;
+
+    for (prevp = &timer_hash[timer_hashval(&te->arg)]; *prevp;
+         prevp = &(*prevp)->next)
+        if (*prevp == te) {
+            *prevp = te->next;
+            te->next = 0;
+            return;
+        }
+    impossible("unhash_timer: timer %ld not found", te->tid);
+}
+
 /* Insert timer into the global queue */
 STATIC_OVL void
 insert_timer(gnu)
 timer_element *gnu;
 {
-    timer_element *curr, *prev;
+    if (timer_heap_cnt == timer_heap_siz) {
+        timer_element **newheap;
+
+        timer_heap_siz = timer_heap_siz ? 2 * timer_heap_siz : 64;
+        newheap = (timer_element **) alloc(timer_heap_siz * sizeof *newheap);
+        if (timer_heap_cnt)
+            (void) memcpy((genericptr_t) newheap, (genericptr_t) timer_heap,
+                          timer_heap_cnt * sizeof *newheap);
+        if (timer_heap)
+            free((genericptr_t) timer_heap);
+        timer_heap = newheap;
+    }
+    gnu->seq = ++timer_seq;
+    timer_heap[timer_heap_cnt] = gnu;
+    heap_sift_up(timer_heap_cnt++);
+    hash_timer(gnu);
+}
 
-    for (prev = 0, curr = timer_base; curr; prev = curr, curr = curr->next)
-        if (curr->timeout >= gnu->timeout)
-            break;
+/* Take timer out of the global queue, but don't free it */
+STATIC_OVL void
+unlink_timer(te)
+timer_element *te;
+{
+    int idx = te->heapidx;
+
+    unhash_timer(te);
+    if (--timer_heap_cnt > idx) {
+        timer_element *last = timer_heap[timer_heap_cnt];
 
-    gnu->next = curr;
-    if (prev)
-        prev->next = gnu;
-    else
-        timer_base = gnu;
+        /* fill the hole with the last element and restore heap order */
+        heap_place(last, idx);
+        heap_sift_up(idx);
+        if (last->heapidx == idx)
+            heap_sift_down(idx);
+    }
+    timer_heap[timer_heap_cnt] = 0;
+    te->heapidx = -1;
 }
 
 STATIC_OVL timer_element *
-remove_timer(base, func_index, arg)
-timer_element **base;
+remove_timer(func_index, arg)
 short func_index;
 anything *arg;
 {
-    timer_element *prev, *curr;
+    timer_element *curr;
 
-    for (prev = 0, curr = *base; curr; prev = curr, curr = curr->next)
+    for (curr = timer_hash[timer_hashval(arg)]; curr; curr = curr->next)
         if (curr->func_index == func_index && curr->arg.a_void == arg->a_void)
             break;
 
-    if (curr) {
-        if (prev)
-            prev->next = curr->next;
-        else
-            *base = curr->next;
-    }
+    if (curr)
+        unlink_timer(curr);
 
     return curr;
 }
@@ -2132,10 +2346,12 @@ maybe_write_timer(fd, range, write_it)
 int fd, range;
 boolean write_it;
 {
-    int count = 0;
-    timer_element *curr;
+    int i, qcount, count = 0;
+    timer_element *curr, **queue;
 
-    for (curr = timer_base; curr; curr = curr->next) {
+    queue = sorted_timers(&qcount);
+    for (i = 0; i < qcount; i++) {
+        curr = queue[i];
         if (range == RANGE_GLOBAL) {
             /* global timers */
 
@@ -2155,6 +2371,7 @@ boolean write_it;
             }
         }
     }
+    free((genericptr_t) queue);
 
     return count;
 }
@@ -2176,8 +2393,8 @@ void
 save_timers(fd, mode, range)
 int fd, mode, range;
 {
-    timer_element *curr, *prev, *next_timer = 0;
-    int count;
+    timer_element *curr;
+    int i, count;
 
     if (perform_bwrite(mode)) {
         if (range == RANGE_GLOBAL)
@@ -2189,20 +2406,26 @@ int fd, mode, range;
     }
 
     if (release_data(mode)) {
-        for (prev = 0, curr = timer_base; curr; curr = next_timer) {
-            next_timer = curr->next; /* in case curr is removed */
-
+        /* squeeze out the released timers, then rebuild the heap */
+        for (count = i = 0; i < timer_heap_cnt; i++) {
+            curr = timer_heap[i];
             if (!(!!(range == RANGE_LEVEL) ^ !!timer_is_local(curr))) {
-                if (prev)
-                    prev->next = curr->next;
-                else
-                    timer_base = curr->next;
+                unhash_timer(curr);
                 free((genericptr_t) curr);
-                /* prev stays the same */
             } else {
-                prev = curr;
+                timer_heap[count++] = curr;
             }
         }
+        timer_heap_cnt = count;
+        for (i = 0; i < timer_heap_cnt; i++)
+            timer_heap[i]->heapidx = i;
+        for (i = timer_heap_cnt / 2 - 1; i >= 0; i--)
+            heap_sift_down(i);
+        if (!timer_heap_cnt && timer_heap) {
+            free((genericptr_t) timer_heap);
+            timer_heap = 0;
+            timer_heap_siz = 0;
+        }
     }
 }
 
@@ -2240,14 +2463,10 @@ const char *hdrfmt;
 char *hdrbuf;
 long *count, *size;
 {
-    timer_element *te;
-
     Sprintf(hdrbuf, hdrfmt, (long) sizeof (timer_element));
-    *count = *size = 0L;
-    for (te = timer_base; te; te = te->next) {
-        ++*count;
-        *size += (long) sizeof *te;
-    }
+    *count = (long) timer_heap_cnt;
+    *size = *count * (long) sizeof (timer_element)
+            + (long) timer_heap_siz * (long) sizeof (timer_element *);
 }
 
 /* reset all timers that are marked for reseting */
@@ -2257,8 +2476,11 @@ boolean ghostly;
 {
     timer_element *curr;
     unsigned nid;
+    int i;
 
-    for (curr = timer_base; curr; curr = curr->next) {
+    /* fixing up a timer changes its hash chain but not its queue slot */
+    for (i = 0; i < timer_heap_cnt; i++) {
+        curr = timer_heap[i];
         if (curr->needs_fixup) {
             if (curr->kind == TIMER_OBJECT) {
                 if (ghostly) {
@@ -2266,9 +2488,12 @@ boolean ghostly;
                         panic("relink_timers 1");
                 } else
                     nid = curr->arg.a_uint;
+                unhash_timer(curr);
+                curr->arg = zeroany;
                 curr->arg.a_obj = find_oid(nid);
                 if (!curr->arg.a_obj)
                     panic("cant find o_id %d", nid);
+                hash_timer(curr);
                 curr->needs_fixup = 0;
             } else if (curr->kind == TIMER_MONSTER) {
                 panic("relink_timers: no monster timer implemented");
@@ -39,6 +39,7 @@ STATIC_DCL boolean FDECL(keep_saddle_with_steedcorpse, (unsigned,
                                                         struct obj *,
                                                         struct obj *));
 STATIC_DCL void NDECL(maybe_finish_sokoban);
+STATIC_DCL void FDECL(reindex_trap_at, (int, int));
 
 /* mintrap() should take a flags argument, but for time being we use this */
 STATIC_VAR int force_mintrap = 0;
@@ -435,6 +436,7 @@ int x, y, typ;
     if (!oldplace) {
         ttmp->ntrap = ftrap;
         ftrap = ttmp;
+        level.traps[x][y] = ttmp;
     } else {
         /* oldplace;
            it shouldn't be possible to override a sokoban pit or hole
@@ -4833,14 +4835,42 @@ struct trap *
 t_at(x, y)
 register int x, y;
 {
-    register struct trap *trap = ftrap;
+    if (!level_index_ok(x, y))
+        return (struct trap *) 0;
+    return level.traps[x][y];
+}
 
-    while (trap) {
+/*
+ * level.traps[x][y] holds the first trap on the ftrap chain at <x,y>.
+ * There is normally at most one, but the Plane of Water's bubbles can
+ * briefly carry a trap on top of another, so when the indexed trap
+ * leaves a spot we look for a successor rather than just clearing it.
+ */
+STATIC_OVL void
+reindex_trap_at(x, y)
+int x, y;
+{
+    register struct trap *trap;
+
+    for (trap = ftrap; trap; trap = trap->ntrap)
         if (trap->tx == x && trap->ty == y)
-            return trap;
-        trap = trap->ntrap;
-    }
-    return (struct trap *) 0;
+            break;
+    level.traps[x][y] = trap;
+}
+
+/* move an existing trap to <x,y> */
+void
+relocate_trap(trap, x, y)
+struct trap *trap;
+int x, y;
+{
+    int ox = trap->tx, oy = trap->ty;
+
+    trap->tx = x;
+    trap->ty = y;
+    if (level.traps[ox][oy] == trap)
+        reindex_trap_at(ox, oy);
+    reindex_trap_at(x, y);
 }
 
 void
@@ -4860,6 +4890,8 @@ register struct trap *trap;
             panic("deltrap: no preceding trap!");
         ttmp->ntrap = trap->ntrap;
     }
+    if (level.traps[trap->tx][trap->ty] == trap)
+        reindex_trap_at(trap->tx, trap->ty);
     if (Sokoban && (trap->ttyp == PIT || trap->ttyp == HOLE))
         maybe_finish_sokoban();
     dealloc_trap(trap);
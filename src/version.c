@@ -276,7 +276,7 @@ const char *name;
     struct version_info vers_info;
     boolean verbose = name ? TRUE : FALSE;
 
-    rlen = read(fd, (genericptr_t) &vers_info, sizeof vers_info);
+    rlen = nhread(fd, (genericptr_t) &vers_info, sizeof vers_info);
     minit(); /* ZEROCOMP */
     if (rlen == 0) {
         if (verbose) {
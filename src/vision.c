@@ -90,9 +90,29 @@ static char cs_rmin1[ROWNO], cs_rmax1[ROWNO];
 static char viz_clear[ROWNO][COLNO]; /* vision clear/blocked map */
 static char *viz_clear_rows[ROWNO];
 
+#ifdef VISION_BITBOARD
+/*
+ * Row bitmasks for algorithm E.  Bit (col % VB_BITS) of word
+ * (col / VB_BITS) stands for column col; bits past COLNO are always 0.
+ */
+#define VB_BITS ((int) (8 * sizeof (unsigned long)))
+#define VB_WORDS ((COLNO + VB_BITS - 1) / VB_BITS)
+#define VB_WORD(col) ((col) / VB_BITS)
+#define VB_BIT(col) (1UL << ((col) % VB_BITS))
+
+static unsigned long viz_block[ROWNO][VB_WORDS]; /* 1 == blocks light */
+static char bb_stale[ROWNO]; /* row's left/right pointers need a rebuild */
+#endif
+
 static char left_ptrs[ROWNO][COLNO]; /* LOS algorithm helpers */
 static char right_ptrs[ROWNO][COLNO];
 
+/* counters for #wizvisionbench:  recalculations done, changes in blocking
+   at spots the hero could see, and how many recalculations those asked for
+   (changes made while one is already pending share it) */
+static long vis_recalc_count = 0L;
+static long vis_block_seen = 0L, vis_block_recalcs = 0L;
+
 /* Forward declarations. */
 STATIC_DCL void FDECL(fill_point, (int, int));
 STATIC_DCL void FDECL(dig_point, (int, int));
@@ -102,6 +122,9 @@ STATIC_DCL void FDECL(view_from, (int, int, char **, char *, char *, int,
                                   genericptr_t));
 STATIC_DCL void FDECL(get_unused_cs, (char ***, char **, char **));
 STATIC_DCL void FDECL(rogue_vision, (char **, char *, char *));
+#ifdef VISION_BITBOARD
+STATIC_DCL int FDECL(bb_clear_line, (int, int, int, int));
+#endif
 
 /* Macro definitions that I can't find anywhere. */
 #define sign(z) ((z) < 0 ? -1 : ((z) ? 1 : 0))
@@ -135,7 +158,7 @@ vision_init()
     vision_full_recalc = 0;
     (void) memset((genericptr_t) could_see, 0, sizeof(could_see));
 
-    /* Initialize the vision algorithm (currently C or D). */
+    /* Initialize the vision algorithm (currently C, D or E). */
     view_init();
 
 #ifdef VISION_TABLES
@@ -193,7 +216,10 @@ void
 vision_reset()
 {
     int y;
-    register int x, i, dig_left, block;
+    register int x;
+#ifndef VISION_BITBOARD
+    register int i, dig_left, block;
+#endif
     register struct rm *lev;
 
     /* Start out with cs0 as our current array */
@@ -207,6 +233,19 @@ vision_reset()
     (void) memset((genericptr_t) viz_clear, 0, sizeof(viz_clear));
 
     /* Dig the level */
+#ifdef VISION_BITBOARD
+    (void) memset((genericptr_t) viz_block, 0, sizeof(viz_block));
+    for (y = 0; y < ROWNO; y++) {
+        viz_block[y][VB_WORD(0)] |= VB_BIT(0); /* (0,y) is always stone */
+        lev = &levl[1][y];
+        for (x = 1; x < COLNO; x++, lev += ROWNO)
+            if (IS_ROCK(lev->typ) || does_block(x, y, lev))
+                viz_block[y][VB_WORD(x)] |= VB_BIT(x);
+            else
+                viz_clear[y][x] = 1;
+        bb_stale[y] = 1;
+    }
+#else
     for (y = 0; y < ROWNO; y++) {
         dig_left = 0;
         block = TRUE; /* location (0,y) is always stone; it's !isok() */
@@ -241,6 +280,12 @@ vision_reset()
             viz_clear[y][i] = !block;
         }
     }
+#endif
+
+    flush_light_cache(); /* the blocking map has been rebuilt */
+#ifdef APPROACH_MAP
+    approach_map_stale();
+#endif
 
     iflags.vision_inited = 1; /* vision is ready */
     vision_full_recalc = 1;   /* we want to run vision_recalc() */
@@ -522,6 +567,7 @@ int control;
     vision_full_recalc = 0; /* reset flag */
     if (in_mklev || !iflags.vision_inited)
         return;
+    vis_recalc_count++;
 
     /*
      * Either the light sources have been taken care of, or we must
@@ -845,8 +891,10 @@ block_point(x, y)
 int x, y;
 {
     fill_point(y, x);
-
-    /* recalc light sources here? */
+    light_block_changed(x, y);
+#ifdef APPROACH_MAP
+    approach_map_stale();
+#endif
 
     /*
      * We have to do a full vision recalculation if we "could see" the
@@ -855,8 +903,12 @@ int x, y;
      * was out of night-vision range of the hero.  Suddenly the hero should
      * see the lit room.
      */
-    if (viz_array[y][x])
+    if (viz_array[y][x]) {
+        vis_block_seen++;
+        if (!vision_full_recalc)
+            vis_block_recalcs++;
         vision_full_recalc = 1;
+    }
 }
 
 /*
@@ -869,11 +921,17 @@ unblock_point(x, y)
 int x, y;
 {
     dig_point(y, x);
+    light_block_changed(x, y);
+#ifdef APPROACH_MAP
+    approach_map_stale();
+#endif
 
-    /* recalc light sources here? */
-
-    if (viz_array[y][x])
+    if (viz_array[y][x]) {
+        vis_block_seen++;
+        if (!vision_full_recalc)
+            vis_block_recalcs++;
         vision_full_recalc = 1;
+    }
 }
 
 /*==========================================================================*\
@@ -927,13 +985,19 @@ STATIC_OVL void
 dig_point(row, col)
 int row, col;
 {
+#ifndef VISION_BITBOARD
     int i;
+#endif
 
     if (viz_clear[row][col])
         return; /* already done */
 
     viz_clear[row][col] = 1;
-
+#ifdef VISION_BITBOARD
+    /* the pointers are rebuilt from the bitmask when they are needed */
+    viz_block[row][VB_WORD(col)] &= ~VB_BIT(col);
+    bb_stale[row] = 1;
+#else
     /*
      * Boundary cases first.
      */
@@ -1006,19 +1070,25 @@ int row, col;
         left_ptrs[row][col] = col - 1;
         right_ptrs[row][col] = col + 1;
     }
+#endif /* ?VISION_BITBOARD */
 }
 
 STATIC_OVL void
 fill_point(row, col)
 int row, col;
 {
+#ifndef VISION_BITBOARD
     int i;
+#endif
 
     if (!viz_clear[row][col])
         return;
 
     viz_clear[row][col] = 0;
-
+#ifdef VISION_BITBOARD
+    viz_block[row][VB_WORD(col)] |= VB_BIT(col);
+    bb_stale[row] = 1;
+#else
     if (col == 0) {
         if (viz_clear[row][1]) { /* adjacent is clear */
             right_ptrs[row][0] = 0;
@@ -1087,15 +1157,16 @@ int row, col;
         for (i = col; i <= right_ptrs[row][col + 1]; i++)
             left_ptrs[row][i] = left_ptrs[row][col - 1];
     }
+#endif /* ?VISION_BITBOARD */
 }
 
 /*==========================================================================*/
 /*==========================================================================*/
-/* Use either algorithm C or D.  See the config.h for more details.
+/* Use algorithm C, D or E.  See the config.h for more details.
  * =========*/
 
 /*
- * Variables local to both Algorithms C and D.
+ * Variables local to Algorithms C, D and E.
  */
 static int start_row;
 static int start_col;
@@ -1108,7 +1179,7 @@ static void FDECL((*vis_func), (int, int, genericptr_t));
 static genericptr_t varg;
 
 /*
- * Both Algorithms C and D use the following macros.
+ * Algorithms C, D and E use the following macros.
  *
  *      good_row(z)       - Return TRUE if the argument is a legal row.
  *      set_cs(rowp,col)  - Set the local could see array.
@@ -1568,6 +1639,11 @@ boolean
 clear_path(col1, row1, col2, row2)
 int col1, row1, col2, row2;
 {
+#ifdef VISION_BITBOARD
+    if (row1 == row2 && col1 == col2)
+        return TRUE;
+    return (boolean) bb_clear_line(row1, col1, row2, col2);
+#else
     int result;
 
     if (col1 < col2) {
@@ -1589,6 +1665,7 @@ int col1, row1, col2, row2;
 cleardone:
 #endif
     return (boolean) result;
+#endif /* ?VISION_BITBOARD */
 }
 
 #ifdef VISION_TABLES
@@ -2287,6 +2364,583 @@ genericptr_t arg;
 }
 
 #else /*===== End of algorithm D =====*/
+#ifdef VISION_BITBOARD
+
+/*==========================================================================*\
+                            GENERAL LINE OF SIGHT
+                                Algorithm E
+\*==========================================================================*/
+
+/*
+ * Algorithm E makes the same row by row scan as algorithm C and marks
+ * exactly the same locations.  What differs is how it gets there:
+ *
+ *      + Line of sight tests don't walk the line.  All four q?_path()
+ *        routines visit the same spots for a given |dx|,|dy| (mirrored),
+ *        and on each row those spots form one run of columns.  The runs
+ *        are worked out once, in view_init(), and a test becomes a mask
+ *        check of each row's run against the viz_block[] row bitmask:
+ *        at most ROWNO checks, no matter how long the line is.
+ *
+ *      + block_point() and unblock_point() only flip a bit in viz_block[]
+ *        and mark the row.  The left and right pointers of a marked row
+ *        are rebuilt, a run at a time, the next time view_from() runs,
+ *        instead of being patched on every change.
+ *
+ *      + The could see marks are collected in row bitmasks and copied
+ *        out to the caller's array (along with the row min and max) once,
+ *        at the end of view_from().
+ *
+ * The run table takes COLNO * ROWNO * (ROWNO + 1) bytes.
+ */
+STATIC_DCL int FDECL(bb_scan_right, (int, int, int));
+STATIC_DCL void FDECL(bb_runs, (int));
+STATIC_DCL void FDECL(bb_mark, (int, int, int));
+STATIC_DCL void FDECL(right_side, (int, int, int, char *));
+STATIC_DCL void FDECL(left_side, (int, int, int, char *));
+
+static unsigned long bb_cs[ROWNO][VB_WORDS];   /* could see marks */
+static unsigned long vb_from[COLNO][VB_WORDS]; /* columns col.. */
+static unsigned long vb_upto[COLNO][VB_WORDS]; /* columns ..col */
+
+/* mask for the part of word i that lies in columns lo..hi */
+#define VB_RANGE(i, lo, hi) (vb_from[lo][i] & vb_upto[hi][i])
+
+/*
+ * Line runs.  For a line with offsets |dx|,|dy|, BB_LINE(dx,dy) points
+ * at dy+1 pairs of column offsets (first, last), one per row starting
+ * with the row of the start point.  A row with no spots to check has
+ * first > last.
+ */
+#define BB_LINES_PER_DX (ROWNO * (ROWNO + 1) / 2)
+#define BB_LINE(dx, dy) \
+    (bb_line[(dx) * BB_LINES_PER_DX + (dy) * ((dy) + 1) / 2])
+static unsigned char bb_line[COLNO * BB_LINES_PER_DX][2];
+
+#if defined(__GNUC__) && (__GNUC__ >= 4)
+#define bb_lowbit(w) __builtin_ctzl(w)
+#define bb_highbit(w) (VB_BITS - 1 - __builtin_clzl(w))
+#else
+STATIC_DCL int FDECL(bb_lowbit, (unsigned long));
+STATIC_DCL int FDECL(bb_highbit, (unsigned long));
+
+/* Index of the lowest set bit.  The word must not be zero. */
+STATIC_OVL int
+bb_lowbit(w)
+unsigned long w;
+{
+    int n = 0;
+
+    while (!(w & 1UL))
+        w >>= 1, n++;
+    return n;
+}
+
+/* Index of the highest set bit.  The word must not be zero. */
+STATIC_OVL int
+bb_highbit(w)
+unsigned long w;
+{
+    int n = 0;
+
+    while (w >>= 1)
+        n++;
+    return n;
+}
+#endif
+
+/*
+ * Initialize algorithm E:  set up the span masks and walk every line
+ * once, the way q4_path() does, to get its runs.
+ */
+STATIC_OVL void
+view_init()
+{
+    int col, i, dx, dy, k, err, x, y, dxs, dys;
+    unsigned char(*run)[2];
+
+    for (col = 0; col < COLNO; col++)
+        for (i = 0; i < VB_WORDS; i++) {
+            if (i < VB_WORD(col))
+                vb_from[col][i] = 0UL, vb_upto[col][i] = ~0UL;
+            else if (i > VB_WORD(col))
+                vb_from[col][i] = ~0UL, vb_upto[col][i] = 0UL;
+            else {
+                vb_from[col][i] = ~0UL << (col % VB_BITS);
+                vb_upto[col][i] = ~0UL >> (VB_BITS - 1 - col % VB_BITS);
+            }
+        }
+
+    for (dx = 0; dx < COLNO; dx++)
+        for (dy = 0; dy < ROWNO; dy++) {
+            run = &BB_LINE(dx, dy);
+            for (y = 0; y <= dy; y++)
+                run[y][0] = COLNO, run[y][1] = 0;
+            if (!dx && !dy)
+                continue; /* the q?_path() routines can't do this one */
+
+            x = y = 0;
+            dxs = dx << 1;
+            dys = dy << 1;
+            if (dy > dx) {
+                err = dxs - dy;
+                for (k = dy - 1; k; k--) {
+                    if (err >= 0) {
+                        x++;
+                        err -= dys;
+                    }
+                    y++;
+                    err += dxs;
+                    run[y][0] = run[y][1] = x; /* one spot per row */
+                }
+            } else {
+                err = dys - dx;
+                for (k = dx - 1; k; k--) {
+                    if (err >= 0) {
+                        y++;
+                        err -= dxs;
+                    }
+                    x++;
+                    err += dys;
+                    if (run[y][0] > x)
+                        run[y][0] = x;
+                    run[y][1] = x;
+                }
+            }
+        }
+}
+
+/*
+ * Return 1 if nothing blocks light between (srow,scol) and (row,col).
+ * Same answer as the q?_path() routine for that quadrant; the end points
+ * are not checked and must not be the same.
+ */
+STATIC_OVL int
+bb_clear_line(srow, scol, row, col)
+int srow, scol, row, col;
+{
+    unsigned char(*run)[2];
+    int dx, dy, rstep, lo, hi;
+    register int i;
+
+    if ((dx = col - scol) < 0)
+        dx = -dx;
+    if ((dy = row - srow) < 0)
+        dy = -dy, rstep = -1;
+    else
+        rstep = 1;
+
+    for (run = &BB_LINE(dx, dy); dy-- >= 0; run++, srow += rstep) {
+        if ((*run)[0] > (*run)[1])
+            continue;
+        if (col < scol)
+            lo = scol - (*run)[1], hi = scol - (*run)[0];
+        else
+            lo = scol + (*run)[0], hi = scol + (*run)[1];
+        for (i = VB_WORD(lo); i <= VB_WORD(hi); i++)
+            if (viz_block[srow][i] & VB_RANGE(i, lo, hi))
+                return 0;
+    }
+    return 1;
+}
+
+/*
+ * Return the first column to the right of col that is blocked (or clear,
+ * if blocked is 0).  Return COLNO if there is none.
+ */
+STATIC_OVL int
+bb_scan_right(row, col, blocked)
+int row, col, blocked;
+{
+    unsigned long w;
+    int i;
+
+    if (++col >= COLNO)
+        return COLNO;
+    i = VB_WORD(col);
+    w = blocked ? viz_block[row][i] : ~viz_block[row][i];
+    w &= vb_from[col][i];
+    for (;;) {
+        if (w) {
+            col = i * VB_BITS + bb_lowbit(w);
+            return (col < COLNO) ? col : COLNO;
+        }
+        if (++i >= VB_WORDS)
+            return COLNO;
+        w = blocked ? viz_block[row][i] : ~viz_block[row][i];
+    }
+}
+
+/*
+ * Rebuild the left and right pointers of a row from its bitmask, one run
+ * of clear or blocked spots at a time.  The values follow the pointer
+ * rules above dig_point().
+ */
+STATIC_OVL void
+bb_runs(row)
+int row;
+{
+    int col, end, left, right;
+    register int i;
+    boolean clear;
+
+    for (col = 0; col < COLNO; col = end + 1) {
+        clear = is_clear(row, col) ? TRUE : FALSE;
+        end = bb_scan_right(row, col, clear) - 1;
+        if (clear) {
+            left = col ? col - 1 : 0;
+            right = (end < COLNO - 1) ? end + 1 : COLNO - 1;
+        } else {
+            left = col;
+            right = end;
+        }
+        for (i = col; i <= end; i++) {
+            left_ptrs[row][i] = left;
+            right_ptrs[row][i] = right;
+        }
+    }
+    bb_stale[row] = 0;
+}
+
+/* Mark columns lo..hi of the row as could see. */
+STATIC_OVL void
+bb_mark(row, lo, hi)
+int row, lo, hi;
+{
+    register int i;
+
+    for (i = VB_WORD(lo); i <= VB_WORD(hi); i++)
+        bb_cs[row][i] |= VB_RANGE(i, lo, hi);
+}
+
+/*
+ * Mark positions as visible on one quadrant of the right side.  This is
+ * algorithm C's right_side(); see there for the comments.
+ */
+STATIC_OVL void
+right_side(row, left, right_mark, limits)
+int row;        /* current row */
+int left;       /* first (left side) visible spot on prev row */
+int right_mark; /* last (right side) visible spot on prev row */
+char *limits;   /* points at range limit for current row, or NULL */
+{
+    int right;      /* right limit of "could see" */
+    int right_edge; /* right edge of an opening */
+    int nrow;       /* new row (calculate once) */
+    int deeper;     /* if TRUE, call self as needed */
+    register int i; /* loop counter */
+    int lim_max;    /* right most limit of circle */
+
+    nrow = row + step;
+    deeper = good_row(nrow) && (!limits || (*limits >= *(limits + 1)));
+    if (limits) {
+        lim_max = start_col + *limits;
+        if (lim_max > COLNO - 1)
+            lim_max = COLNO - 1;
+        if (right_mark > lim_max)
+            right_mark = lim_max;
+        limits++; /* prepare for next row */
+    } else
+        lim_max = COLNO - 1;
+
+    while (left <= right_mark) {
+        right_edge = right_ptrs[row][left];
+        if (right_edge > lim_max)
+            right_edge = lim_max;
+
+        if (!is_clear(row, left)) {
+            /* Jump to the far side of a stone wall. */
+            if (right_edge > right_mark) {
+                /* Maybe see more (kludge). */
+                right_edge = is_clear(row - step, right_mark) ? right_mark + 1
+                                                              : right_mark;
+            }
+            if (vis_func) {
+                for (i = left; i <= right_edge; i++)
+                    (*vis_func)(i, row, varg);
+            } else {
+                bb_mark(row, left, right_edge);
+            }
+            left = right_edge + 1; /* no limit check necessary */
+            continue;
+        }
+
+        if (left != start_col) {
+            /* Find the left side. */
+            for (; left <= right_edge; left++)
+                if (bb_clear_line(start_row, start_col, row, left))
+                    break;
+
+            /* Check for boundary conditions. */
+            if (left > lim_max)
+                return;
+            if (left == lim_max) {
+                if (vis_func)
+                    (*vis_func)(lim_max, row, varg);
+                else
+                    bb_mark(row, lim_max, lim_max);
+                return;
+            }
+            /* Check if we can see any spots in the opening. */
+            if (left >= right_edge) {
+                left = right_edge;
+                continue;
+            }
+        }
+
+        /* Find the right side. */
+        if (right_mark < right_edge) {
+            for (right = right_mark; right <= right_edge; right++)
+                if (!bb_clear_line(start_row, start_col, row, right))
+                    break;
+            --right; /* get rid of the last increment */
+        } else
+            right = right_edge;
+
+        if (left <= right) {
+            /* An ugly special case. */
+            if (left == right && left == start_col && start_col < (COLNO - 1)
+                && !is_clear(row, start_col + 1))
+                right = start_col + 1;
+
+            if (right > lim_max)
+                right = lim_max;
+            if (vis_func) {
+                for (i = left; i <= right; i++)
+                    (*vis_func)(i, row, varg);
+            } else {
+                bb_mark(row, left, right);
+            }
+
+            /* Recurse */
+            if (deeper)
+                right_side(nrow, left, right, limits);
+            left = right + 1; /* no limit check necessary */
+        }
+    }
+}
+
+/*
+ * This routine is the mirror image of right_side().
+ */
+STATIC_OVL void
+left_side(row, left_mark, right, limits)
+int row, left_mark, right;
+char *limits;
+{
+    int left, left_edge, nrow, deeper;
+    register int i;
+    int lim_min;
+
+    nrow = row + step;
+    deeper = good_row(nrow) && (!limits || (*limits >= *(limits + 1)));
+    if (limits) {
+        lim_min = start_col - *limits;
+        if (lim_min < 0)
+            lim_min = 0;
+        if (left_mark < lim_min)
+            left_mark = lim_min;
+        limits++; /* prepare for next row */
+    } else
+        lim_min = 0;
+
+    while (right >= left_mark) {
+        left_edge = left_ptrs[row][right];
+        if (left_edge < lim_min)
+            left_edge = lim_min;
+
+        if (!is_clear(row, right)) {
+            /* Jump to the far side of a stone wall. */
+            if (left_edge < left_mark) {
+                /* Maybe see more (kludge). */
+                left_edge = is_clear(row - step, left_mark) ? left_mark - 1
+                                                            : left_mark;
+            }
+            if (vis_func) {
+                for (i = left_edge; i <= right; i++)
+                    (*vis_func)(i, row, varg);
+            } else {
+                bb_mark(row, left_edge, right);
+            }
+            right = left_edge - 1; /* no limit check necessary */
+            continue;
+        }
+
+        if (right != start_col) {
+            /* Find the right side. */
+            for (; right >= left_edge; right--)
+                if (bb_clear_line(start_row, start_col, row, right))
+                    break;
+
+            /* Check for boundary conditions. */
+            if (right < lim_min)
+                return;
+            if (right == lim_min) {
+                if (vis_func)
+                    (*vis_func)(lim_min, row, varg);
+                else
+                    bb_mark(row, lim_min, lim_min);
+                return;
+            }
+            /* Check if we can see any spots in the opening. */
+            if (right <= left_edge) {
+                right = left_edge;
+                continue;
+            }
+        }
+
+        /* Find the left side. */
+        if (left_mark > left_edge) {
+            for (left = left_mark; left >= left_edge; --left)
+                if (!bb_clear_line(start_row, start_col, row, left))
+                    break;
+            left++; /* get rid of the last decrement */
+        } else
+            left = left_edge;
+
+        if (left <= right) {
+            /* An ugly special case. */
+            if (left == right && right == start_col && start_col > 0
+                && !is_clear(row, start_col - 1))
+                left = start_col - 1;
+
+            if (left < lim_min)
+                left = lim_min;
+            if (vis_func) {
+                for (i = left; i <= right; i++)
+                    (*vis_func)(i, row, varg);
+            } else {
+                bb_mark(row, left, right);
+            }
+
+            /* Recurse */
+            if (deeper)
+                left_side(nrow, left, right, limits);
+            right = left - 1; /* no limit check necessary */
+        }
+    }
+}
+
+/*
+ * Calculate all possible visible locations from the given location
+ * (srow,scol).  NOTE this is (y,x)!  Mark the visible locations in the
+ * array provided.
+ */
+STATIC_OVL void
+view_from(srow, scol, loc_cs_rows, left_most, right_most, range, func, arg)
+int srow, scol;     /* starting row and column */
+char **loc_cs_rows; /* pointers to the rows of the could_see array */
+char *left_most;    /* min mark on each row */
+char *right_most;   /* max mark on each row */
+int range;          /* 0 if unlimited */
+void FDECL((*func), (int, int, genericptr_t));
+genericptr_t arg;
+{
+    register int i; /* loop counter */
+    int row;        /* row counter */
+    int nrow;       /* the next row */
+    int left;       /* the left-most visible column */
+    int right;      /* the right-most visible column */
+    char *limits;   /* range limit for next row */
+    char *rowp;     /* optimization for setting could_see */
+    unsigned long w;
+
+    /* Set globals for left_side() and right_side() to use. */
+    start_col = scol;
+    start_row = srow;
+    cs_rows = loc_cs_rows; /* 'could see' rows */
+    cs_left = left_most;
+    cs_right = right_most;
+    vis_func = func;
+    varg = arg;
+
+    for (row = 0; row < ROWNO; row++)
+        if (bb_stale[row])
+            bb_runs(row);
+    if (!func)
+        (void) memset((genericptr_t) bb_cs, 0, sizeof bb_cs);
+
+    /*
+     * Determine extent of sight on the starting row.
+     */
+    if (is_clear(srow, scol)) {
+        left = left_ptrs[srow][scol];
+        right = right_ptrs[srow][scol];
+    } else {
+        /*
+         * When in stone, you can only see your adjacent squares, unless
+         * you are on an array boundary or a stone/clear boundary.
+         */
+        left = (!scol) ? 0
+                       : (is_clear(srow, scol - 1) ? left_ptrs[srow][scol - 1]
+                                                   : scol - 1);
+        right = (scol == COLNO - 1)
+                    ? COLNO - 1
+                    : (is_clear(srow, scol + 1) ? right_ptrs[srow][scol + 1]
+                                                : scol + 1);
+    }
+
+    if (range) {
+        if (range > MAX_RADIUS || range < 1)
+            panic("view_from called with range %d", range);
+        limits = circle_ptr(range) + 1; /* start at next row */
+        if (left < scol - range)
+            left = scol - range;
+        if (right > scol + range)
+            right = scol + range;
+    } else
+        limits = (char *) 0;
+
+    if (func) {
+        for (i = left; i <= right; i++)
+            (*func)(i, srow, arg);
+    } else {
+        /* We know that we can see our row. */
+        bb_mark(srow, left, right);
+    }
+
+    /*
+     * Check what could be seen in quadrants.
+     */
+    if ((nrow = srow + 1) < ROWNO) { /* move down */
+        step = 1;
+        if (scol < COLNO - 1)
+            right_side(nrow, scol, right, limits);
+        if (scol)
+            left_side(nrow, left, scol, limits);
+    }
+
+    if ((nrow = srow - 1) >= 0) { /* move up */
+        step = -1;
+        if (scol < COLNO - 1)
+            right_side(nrow, scol, right, limits);
+        if (scol)
+            left_side(nrow, left, scol, limits);
+    }
+
+    if (func)
+        return;
+
+    /* Copy the marks out to the could see array. */
+    for (row = 0; row < ROWNO; row++) {
+        for (i = 0; i < VB_WORDS && !bb_cs[row][i]; i++)
+            continue;
+        if (i == VB_WORDS)
+            continue; /* nothing on this row */
+        cs_left[row] = i * VB_BITS + bb_lowbit(bb_cs[row][i]);
+
+        rowp = cs_rows[row];
+        for (; i < VB_WORDS; i++)
+            for (w = bb_cs[row][i]; w; w &= w - 1)
+                set_cs(rowp, i * VB_BITS + bb_lowbit(w));
+
+        for (i = VB_WORDS - 1; !bb_cs[row][i]; i--)
+            continue;
+        cs_right[row] = i * VB_BITS + bb_highbit(bb_cs[row][i]);
+    }
+}
+
+#else /*===== End of algorithm E =====*/
 
 /*==========================================================================*\
                             GENERAL LINE OF SIGHT
@@ -2731,6 +3385,7 @@ genericptr_t arg;
 }
 
 #endif /*===== End of algorithm C =====*/
+#endif /* VISION_TABLES */
 
 /*
  * AREA OF EFFECT "ENGINE"
@@ -2824,4 +3479,66 @@ struct monst *mon;
     return how_seen;
 }
 
+/*
+ * Wizard mode #wizvisionbench:  report how many vision recalculations were
+ * done and how many of them block_point()/unblock_point() asked for, then
+ * time full vision recalculations at the hero's location and view_from()
+ * from every location on the level that doesn't block sight.  Run it on
+ * the same level in builds with and without VISION_TABLES or
+ * VISION_BITBOARD to compare the algorithms.
+ */
+void
+vision_bench()
+{
+    char **rows, *rmin, *rmax;
+    clock_t start, recalc_ticks, view_ticks;
+    long recalcs, views;
+    int x, y, pass;
+    const char *algorithm =
+#ifdef VISION_TABLES
+        "D (tables)";
+#else
+#ifdef VISION_BITBOARD
+        "E (row bitmasks)";
+#else
+        "C";
+#endif
+#endif
+
+    pline("%ld vision recalcs so far, %ld of them for %ld %s.",
+          vis_recalc_count, vis_block_recalcs, vis_block_seen,
+          "changes in blocking within view");
+
+    start = clock();
+    for (recalcs = 0L; recalcs < 2000L; recalcs++) {
+        vision_full_recalc = 1;
+        vision_recalc(0);
+    }
+    recalc_ticks = clock() - start;
+
+    views = 0L;
+    start = clock();
+    for (pass = 0; pass < 10; pass++)
+        for (y = 0; y < ROWNO; y++)
+            for (x = 1; x < COLNO; x++)
+                if (viz_clear[y][x]) {
+                    get_unused_cs(&rows, &rmin, &rmax);
+                    view_from(y, x, rows, rmin, rmax, 0,
+                              (void FDECL((*), (int, int, genericptr_t))) 0,
+                              (genericptr_t) 0);
+                    views++;
+                }
+    view_ticks = clock() - start;
+
+    if (recalc_ticks <= 0)
+        recalc_ticks = 1;
+    if (view_ticks <= 0)
+        view_ticks = 1;
+    pline("Vision algorithm %s.", algorithm);
+    pline("vision_recalc: %ld calls, %ld per second.", recalcs,
+          (long) ((double) recalcs * CLOCKS_PER_SEC / recalc_ticks));
+    pline("view_from: %ld calls, %ld per second.", views,
+          (long) ((double) views * CLOCKS_PER_SEC / view_ticks));
+}
+
 /*vision.c*/
@@ -85,6 +85,9 @@ eraseoldlocks()
         set_levelfile_name(lock, i);
         (void) unlink(fqname(lock, LEVELPREFIX, 0));
     }
+#ifdef INSURANCE
+    chkpt_discard(0); /* the checkpoint journal */
+#endif
     set_levelfile_name(lock, 0);
     if (unlink(fqname(lock, LEVELPREFIX, 0)))
         return 0; /* cannot remove it */
@@ -116,6 +116,7 @@ void FDECL(add_opcode, (sp_lev *, int, genericptr_t));
 
 static boolean FDECL(write_common_data, (int));
 static boolean FDECL(write_maze, (int, sp_lev *));
+static boolean FDECL(fold_math_opcode, (sp_lev *, int));
 static void NDECL(init_obj_classes);
 static int FDECL(case_insensitive_comp, (const char *, const char *));
 
@@ -1319,6 +1320,56 @@ char c;
     return (INVALID_TYPE);
 }
 
+/*
+ * Constant folding: if an integer math opcode is about to be added right
+ * after the pushes of both of its operands, and both are integer
+ * constants, do the arithmetic now and leave a single push of the result
+ * instead of three opcodes.  The expression code is emitted in postfix
+ * order, so the two pushes immediately preceding the operator are its
+ * operands.  Division and modulo follow sp_level_coder()'s rules for
+ * zero and negative divisors.
+ */
+static boolean
+fold_math_opcode(sp, opc)
+sp_lev *sp;
+int opc;
+{
+    long nop = sp->n_opcodes;
+    struct opvar *a, *b;
+
+    if (nop < 2 || sp->opcodes[nop - 1].opcode != SPO_PUSH
+        || sp->opcodes[nop - 2].opcode != SPO_PUSH)
+        return FALSE;
+    a = (struct opvar *) sp->opcodes[nop - 2].opdat;
+    b = (struct opvar *) sp->opcodes[nop - 1].opdat;
+    if (!a || !b || a->spovartyp != SPOVAR_INT || b->spovartyp != SPOVAR_INT)
+        return FALSE;
+
+    switch (opc) {
+    case SPO_MATH_ADD:
+        a->vardata.l += b->vardata.l;
+        break;
+    case SPO_MATH_SUB:
+        a->vardata.l -= b->vardata.l;
+        break;
+    case SPO_MATH_MUL:
+        a->vardata.l *= b->vardata.l;
+        break;
+    case SPO_MATH_DIV:
+        a->vardata.l = (b->vardata.l >= 1) ? a->vardata.l / b->vardata.l : 0L;
+        break;
+    case SPO_MATH_MOD:
+        a->vardata.l = (b->vardata.l > 0) ? a->vardata.l % b->vardata.l : 0L;
+        break;
+    default:
+        return FALSE;
+    }
+    Free(b);
+    sp->opcodes[nop - 1].opdat = NULL;
+    sp->n_opcodes--;
+    return TRUE;
+}
+
 void
 add_opcode(sp, opc, dat)
 sp_lev *sp;
@@ -1331,6 +1382,10 @@ genericptr_t dat;
     if ((opc < 0) || (opc >= MAX_SP_OPCODES))
         lc_error("Unknown opcode '%ld'", VA_PASS1((long) opc));
 
+    if (opc >= SPO_MATH_ADD && opc <= SPO_MATH_MOD && !dat
+        && fold_math_opcode(sp, opc))
+        return;
+
     tmp = (_opcode *) alloc(sizeof(_opcode) * (nop + 1));
     if (!tmp) { /* lint suppression */
         /*NOTREACHED*/
@@ -177,6 +177,8 @@ static char *FDECL(version_string, (char *, const char *));
 static char *FDECL(version_id_string, (char *, const char *));
 static char *FDECL(bannerc_string, (char *, const char *));
 static char *FDECL(xcrypt, (const char *));
+static void FDECL(add_lineoff, (long));
+static boolean FDECL(put_lineoffs, (FILE *, long));
 static unsigned long FDECL(read_rumors_file,
                            (const char *, int *, long *, unsigned long));
 static boolean FDECL(get_gitinfo, (char *, char *));
@@ -879,6 +881,48 @@ const char *str;
     return buf;
 }
 
+/*
+ * Line offset tables for rumors and the other random-access text files.
+ * The table goes between the file's header and its text, one "%06lx"
+ * line per line of text plus one for end-of-file, so that the game can
+ * pick a line by number with a seek into the table instead of seeking to
+ * a random byte.  Selection by byte offset is relative to the start of
+ * the text, so putting the table in front of it doesn't change which line
+ * that method picks.
+ */
+static long *lineoffs = 0;
+static int lineoff_cnt = 0, lineoff_max = 0;
+
+static void
+add_lineoff(offset)
+long offset;
+{
+    if (lineoff_cnt == lineoff_max) {
+        lineoff_max += 256;
+        lineoffs = (long *) realloc((genericptr_t) lineoffs,
+                                    lineoff_max * sizeof *lineoffs);
+        if (!lineoffs) {
+            perror("line offset table");
+            exit(EXIT_FAILURE);
+        }
+    }
+    lineoffs[lineoff_cnt++] = offset;
+}
+
+/* write the table with 'delta' added to each offset; FALSE on error */
+static boolean
+put_lineoffs(fp, delta)
+FILE *fp;
+long delta;
+{
+    int i;
+
+    for (i = 0; i < lineoff_cnt; i++)
+        if (fprintf(fp, "%06lx\n", (unsigned long) (lineoffs[i] + delta)) < 0)
+            return FALSE;
+    return TRUE;
+}
+
 #define PAD_RUMORS_TO 60
 /* common code for do_rumors().  Return 0 on error. */
 static unsigned long
@@ -922,6 +966,7 @@ unsigned long old_rumor_offset;
         }
 #endif
         (*rumor_count)++;
+        add_lineoff(ftell(tfp));
 #if 0
         /*[if we forced binary output, this would be sufficient]*/
         *rumor_size += strlen(line); /* includes newline */
@@ -947,6 +992,7 @@ do_rnd_access_file(fname)
 const char *fname;
 {
     char *line;
+    long table_offset;
 
     Sprintf(filename, DATA_IN_TEMPLATE, fname);
     Strcat(filename, ".txt");
@@ -969,12 +1015,38 @@ const char *fname;
     grep0(ifp, tfp);
     ifp = getfp(DATA_TEMPLATE, "grep.tmp", RDTMODE);
 
+    /* count the lines, then output the count and a dummy offset table */
+    lineoff_cnt = 0;
     while ((line = fgetline(ifp)) != 0) {
         if (line[0] != '#' && line[0] != '\n')
+            add_lineoff(0L);
+        free(line);
+    }
+    add_lineoff(0L); /* end of file */
+    Fprintf(ofp, "%05d\n", lineoff_cnt - 1);
+    table_offset = ftell(ofp);
+    (void) put_lineoffs(ofp, 0L);
+
+    if (rewind(ifp) != 0) {
+        perror("grep.tmp");
+        exit(EXIT_FAILURE);
+    }
+    lineoff_cnt = 0;
+    while ((line = fgetline(ifp)) != 0) {
+        if (line[0] != '#' && line[0] != '\n') {
+            add_lineoff(ftell(ofp));
             (void) fputs(xcrypt(line), ofp);
+        }
         free(line);
     }
+    add_lineoff(ftell(ofp));
     Fclose(ifp);
+    if (fseek(ofp, table_offset, SEEK_SET) < 0 || !put_lineoffs(ofp, 0L)) {
+        perror(filename);
+        Fclose(ofp);
+        Unlink(filename);
+        exit(EXIT_FAILURE);
+    }
     Fclose(ofp);
 
     delete_file(DATA_TEMPLATE, "grep.tmp");
@@ -989,7 +1061,7 @@ do_rumors()
         "%s%04d,%06ld,%06lx;%04d,%06ld,%06lx;0,0,%06lx\n";
     char tempfile[600];
     int true_rumor_count, false_rumor_count;
-    long true_rumor_size, false_rumor_size;
+    long true_rumor_size, false_rumor_size, delta;
     unsigned long true_rumor_offset, false_rumor_offset, eof_offset;
 
     Sprintf(tempfile, DATA_TEMPLATE, "rumors.tmp");
@@ -1011,6 +1083,7 @@ do_rumors()
     true_rumor_count = false_rumor_count = 0;
     true_rumor_size = false_rumor_size = 0L;
     true_rumor_offset = false_rumor_offset = eof_offset = 0L;
+    lineoff_cnt = 0;
 
     /* output a dummy header record; we'll replace it in final output */
     Fprintf(tfp, rumors_header, Dont_Edit_Data, true_rumor_count,
@@ -1028,6 +1101,7 @@ do_rumors()
                                   &false_rumor_size, false_rumor_offset);
     if (!eof_offset)
         goto rumors_failure;
+    add_lineoff((long) eof_offset);
 
     /* get ready to transfer the contents of temp file to output file */
     line = malloc(256);
@@ -1039,10 +1113,14 @@ do_rumors()
     }
     free(line);
 
-    /* output the header record */
+    /* output a header record and line offset table, both of which will
+       be rewritten once the table's size is known */
     Fprintf(ofp, rumors_header, Dont_Edit_Data, true_rumor_count,
             true_rumor_size, true_rumor_offset, false_rumor_count,
             false_rumor_size, false_rumor_offset, eof_offset);
+    (void) put_lineoffs(ofp, 0L);
+    /* the text will follow the table instead of the header */
+    delta = ftell(ofp) - (long) true_rumor_offset;
     /* skip the temp file's dummy header */
     if (!(line = fgetline(tfp))) { /* "Don't Edit" */
         perror(tempfile);
@@ -1062,6 +1140,20 @@ do_rumors()
     /* all done; delete temp file */
     Fclose(tfp);
     Unlink(tempfile);
+    /* rewrite the header and the table with the final offsets */
+    true_rumor_offset += delta;
+    false_rumor_offset += delta;
+    eof_offset += delta;
+    if (rewind(ofp) != 0
+        || fprintf(ofp, rumors_header, Dont_Edit_Data, true_rumor_count,
+                   true_rumor_size, true_rumor_offset, false_rumor_count,
+                   false_rumor_size, false_rumor_offset, eof_offset) < 0
+        || !put_lineoffs(ofp, delta)) {
+        perror(filename);
+        Fclose(ofp);
+        Unlink(filename);
+        exit(EXIT_FAILURE);
+    }
     Fclose(ofp);
     return;
 
@@ -1519,6 +1611,12 @@ static const char *build_opts[] = {
 #ifdef ZLIB_COMP
     "ZLIB data file compression",
 #endif
+#ifdef LZCOMP
+    "built-in block compression of save files",
+#endif
+#ifdef SAVECRC
+    "checksummed save files",
+#endif
 #ifdef DLB
     "data librarian",
 #endif
@@ -1549,6 +1647,9 @@ static const char *build_opts[] = {
 #ifdef MAIL
     "mail daemon",
 #endif
+#ifdef APPROACH_MAP
+    "monster pathing around obstacles",
+#endif
 #ifdef GNUDOS
     "MSDOS protected mode",
 #endif
@@ -1632,6 +1733,9 @@ static const char *build_opts[] = {
 #ifdef RLECOMP
     "run-length compression of map in save files",
 #endif
+#ifdef COLCOMP
+    "field-by-field compression of map in save files",
+#endif
 #ifdef SYSCF
     "system configuration at run-time",
 #endif
@@ -1802,7 +1906,8 @@ char *line;
  *
      New format (v3.1) of 'data' file which allows much faster lookups [pr]
 "do not edit"           first record is a comment line
-01234567                hexadecimal formatted offset to text area
+01234567 0089abcd       hexadecimal formatted offsets to text area and to
+                        the key index (the latter added in 3.6.2)
 name-a                  first name of interest
 123,4                   offset to name's text, and number of lines for it
 name-b                  next name of interest
@@ -1810,6 +1915,10 @@ name-c                  multiple names which share same description also
 456,7                   share a single offset,count line
 .                       sentinel to mark end of names
 789,0                   dummy record containing offset, count of EOF
+2 1                     key index:  number of literal and wildcard keys,
+0 123,4 name-a          then "ordinal offset,count key" for each literal
+2 456,7 name-c          key, followed by the same for each key containing
+1 456,7 name-?          '*' or '?'; ordinal is the key's position above
 text-a                  4 lines of descriptive text for name-a
 text-a                  at file position 0x01234567L + 123L
 text-a
@@ -1818,16 +1927,33 @@ text-b/text-c           7 lines of text for names-b and -c
 text-b/text-c           at fseek(0x01234567L + 456L)
 ...
  *
+ * The key index lets checkfile() find literal keys with a hash lookup and
+ * only run pmatch() on the wildcard ones; ordinals preserve the first-match
+ * order of the sequential scan, including "~" keys which skip their entry.
  */
 
+struct d_key {
+    char *key;   /* key text, including any leading '~' */
+    long offset; /* offset of its entry's text */
+    int count;   /* number of lines of text */
+};
+
+static int
+d_wildkey(key)
+const char *key;
+{
+    return (index(key, '*') || index(key, '?')) ? 1 : 0;
+}
+
 void
 do_data()
 {
     char infile[60], tempfile[60];
     boolean ok;
-    long txt_offset;
-    int entry_cnt, line_cnt;
-    char *line;
+    long txt_offset, idx_offset, entry_offset;
+    int entry_cnt, line_cnt, key_cnt, key_max, entry_key, i, wild;
+    struct d_key *keys;
+    char *line, *p;
 
     Sprintf(tempfile, DATA_TEMPLATE, "database.tmp");
     filename[0] = '\0';
@@ -1859,9 +1985,11 @@ do_data()
     }
 
     /* output a dummy header record; we'll rewind and overwrite it later */
-    Fprintf(ofp, "%s%08lx\n", Dont_Edit_Data, 0L);
+    Fprintf(ofp, "%s%08lx %08lx\n", Dont_Edit_Data, 0L, 0L);
 
-    entry_cnt = line_cnt = 0;
+    entry_cnt = line_cnt = key_cnt = key_max = entry_key = 0;
+    entry_offset = 0L;
+    keys = (struct d_key *) 0;
     /* read through the input file and split it into two sections */
     while ((line = fgetline(ifp)) != 0) {
         if (d_filter(line)) {
@@ -1870,15 +1998,38 @@ do_data()
         }
         if (*line > ' ') { /* got an entry name */
             /* first finish previous entry */
-            if (line_cnt)
-                Fprintf(ofp, "%d\n", line_cnt), line_cnt = 0;
+            if (line_cnt) {
+                Fprintf(ofp, "%d\n", line_cnt);
+                for (; entry_key < key_cnt; entry_key++) {
+                    keys[entry_key].offset = entry_offset;
+                    keys[entry_key].count = line_cnt;
+                }
+                line_cnt = 0;
+            }
             /* output the entry name */
             (void) fputs(line, ofp);
             entry_cnt++;        /* update number of entries */
+            /* and remember it for the index */
+            if (key_cnt == key_max) {
+                key_max += 256;
+                keys = (struct d_key *) realloc((genericptr_t) keys,
+                                                key_max * sizeof *keys);
+                if (!keys) {
+                    perror("data key index");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            if ((p = index(line, '\n')) != 0) {
+                *p = '\0';
+                if (p > line && p[-1] == '\r')
+                    p[-1] = '\0';
+            }
+            keys[key_cnt++].key = line;
+            continue; /* keep line */
         } else if (entry_cnt) { /* got some descriptive text */
             /* update previous entry with current text offset */
             if (!line_cnt)
-                Fprintf(ofp, "%ld,", ftell(tfp));
+                Fprintf(ofp, "%ld,", entry_offset = ftell(tfp));
             /* save the text line in the scratch file */
             (void) fputs(line, tfp);
             line_cnt++; /* update line counter */
@@ -1886,9 +2037,33 @@ do_data()
         free(line);
     }
     /* output an end marker and then record the current position */
-    if (line_cnt)
+    if (line_cnt) {
         Fprintf(ofp, "%d\n", line_cnt);
+        for (; entry_key < key_cnt; entry_key++) {
+            keys[entry_key].offset = entry_offset;
+            keys[entry_key].count = line_cnt;
+        }
+    }
     Fprintf(ofp, ".\n%ld,%d\n", ftell(tfp), 0);
+    /* trailing names without text share the dummy EOF record */
+    for (; entry_key < key_cnt; entry_key++) {
+        keys[entry_key].offset = ftell(tfp);
+        keys[entry_key].count = 0;
+    }
+    /* output the key index, literal keys first */
+    idx_offset = ftell(ofp);
+    for (wild = i = 0; i < key_cnt; i++)
+        wild += d_wildkey(keys[i].key);
+    Fprintf(ofp, "%d %d\n", key_cnt - wild, wild);
+    for (wild = 0; wild <= 1; wild++)
+        for (i = 0; i < key_cnt; i++)
+            if (d_wildkey(keys[i].key) == wild)
+                Fprintf(ofp, "%d %ld,%d %s\n", i, keys[i].offset,
+                        keys[i].count, keys[i].key);
+    for (i = 0; i < key_cnt; i++)
+        free(keys[i].key);
+    if (keys)
+        free((genericptr_t) keys);
     txt_offset = ftell(ofp);
     Fclose(ifp); /* all done with original input file */
 
@@ -1914,8 +2089,9 @@ do_data()
     ok = (rewind(ofp) == 0);
     if (ok) {
         Sprintf(line, "header rewrite of \"%s\"", filename);
-        ok = (fprintf(ofp, "%s%08lx\n", Dont_Edit_Data,
-                      (unsigned long) txt_offset) >= 0);
+        ok = (fprintf(ofp, "%s%08lx %08lx\n", Dont_Edit_Data,
+                      (unsigned long) txt_offset,
+                      (unsigned long) idx_offset) >= 0);
     }
     if (!ok) {
     dead_data:
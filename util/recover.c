@@ -15,6 +15,14 @@
 #include <errno.h>
 #include "win32api.h"
 #endif
+#ifdef UNIX
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+#ifdef MMAP_RESTORE
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
 
 #ifdef VMS
 extern int FDECL(vms_creat, (const char *, unsigned));
@@ -22,10 +30,15 @@ extern int FDECL(vms_open, (const char *, int, unsigned));
 #endif /* VMS */
 
 int FDECL(restore_savefile, (char *));
+void FDECL(recover_game, (char *, int));
+#ifdef UNIX
+void FDECL(recover_games, (char **, int, int, int));
+#endif
 void FDECL(set_levelfile_name, (int));
 int FDECL(open_levelfile, (int));
 int NDECL(create_savefile);
-void FDECL(copy_bytes, (int, int));
+int FDECL(copy_bytes, (int, int));
+void FDECL(apply_journal, (char *));
 
 #ifndef WIN_CE
 #define Fprintf (void) fprintf
@@ -60,13 +73,61 @@ extern unsigned _stklen = STKSIZ;
 char
     savename[SAVESIZE]; /* holds relative path of save file from playground */
 
+static void
+usage(prog, dir)
+const char *prog, *dir;
+{
+    Fprintf(stderr, "Usage: %s [ -d directory ]%s base1 [ base2 ... ]\n",
+            prog,
+#ifdef UNIX
+            " [ -j jobs ] [ -f listfile ] [ -s summary ]"
+#else
+            " [ -f listfile ] [ -s summary ]"
+#endif
+            );
+#if defined(WIN32) || defined(MSDOS)
+    if (dir) {
+        Fprintf(stderr,
+                "\t(Unless you override it with -d, recover will look \n");
+        Fprintf(stderr, "\t in the %s directory on your system)\n", dir);
+    }
+#endif
+    exit(EXIT_FAILURE);
+}
+
+/* add a base name to the list of games to recover */
+static void
+add_name(name, names, nnames, maxnames)
+const char *name;
+char ***names;
+int *nnames, *maxnames;
+{
+    if (*nnames == *maxnames) {
+        *maxnames = *maxnames ? *maxnames * 2 : 64;
+        *names = (char **) realloc((genericptr_t) *names,
+                                   *maxnames * sizeof (char *));
+        if (!*names) {
+            Fprintf(stderr, "recover: out of memory.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (!((*names)[*nnames] = (char *) malloc(strlen(name) + 1))) {
+        Fprintf(stderr, "recover: out of memory.\n");
+        exit(EXIT_FAILURE);
+    }
+    (void) strcpy((*names)[(*nnames)++], name);
+}
+
 int
 main(argc, argv)
 int argc;
 char *argv[];
 {
-    int argno;
-    const char *dir = (char *) 0;
+    int argno, nnames = 0, maxnames = 0, jobs = 1, sumfd = -1, i;
+    const char *dir = (char *) 0, *listfile = (char *) 0,
+               *summary = (char *) 0, *val;
+    char **names = (char **) 0, buf[BUFSIZ], *p, flag;
+    FILE *lf;
 #ifdef AMIGA
     char *startdir = (char *) 0;
 #endif
@@ -79,36 +140,78 @@ char *argv[];
     if (!dir)
         dir = exepath(argv[0]);
 #endif
-    if (argc == 1 || (argc == 2 && !strcmp(argv[1], "-"))) {
-        Fprintf(stderr, "Usage: %s [ -d directory ] base1 [ base2 ... ]\n",
-                argv[0]);
-#if defined(WIN32) || defined(MSDOS)
-        if (dir) {
-            Fprintf(
-                stderr,
-                "\t(Unless you override it with -d, recover will look \n");
-            Fprintf(stderr, "\t in the %s directory on your system)\n", dir);
+    if (argc == 1 || (argc == 2 && !strcmp(argv[1], "-")))
+        usage(argv[0], dir);
+
+    /* -d directory, -j number of worker processes, -f file naming more
+       games, one per line ("-" for stdin), -s file for the summary ("-"
+       for stdout); each value may follow directly, after '=' or ':', or
+       as the next argument */
+    for (argno = 1; argno < argc && argv[argno][0] == '-' && argv[argno][1];
+         argno++) {
+        flag = argv[argno][1];
+        if (!index("djfs", flag))
+            usage(argv[0], dir);
+        val = argv[argno] + 2;
+        if (*val == '=' || *val == ':')
+            val++;
+        if (!*val && argno + 1 < argc)
+            val = argv[++argno];
+        if (!*val) {
+            Fprintf(stderr, "%s: flag -%c must be followed by %s.\n",
+                    argv[0], flag,
+                    (flag == 'd') ? "a directory name"
+                    : (flag == 'j') ? "a number" : "a file name");
+            exit(EXIT_FAILURE);
+        }
+        switch (flag) {
+        case 'd':
+            dir = val;
+            break;
+        case 'j':
+            jobs = atoi(val);
+            break;
+        case 'f':
+            listfile = val;
+            break;
+        case 's':
+            summary = val;
+            break;
         }
-#endif
-        exit(EXIT_FAILURE);
     }
-
-    argno = 1;
-    if (!strncmp(argv[argno], "-d", 2)) {
-        dir = argv[argno] + 2;
-        if (*dir == '=' || *dir == ':')
-            dir++;
-        if (!*dir && argc > argno) {
-            argno++;
-            dir = argv[argno];
+    for (; argno < argc; argno++)
+        add_name(argv[argno], &names, &nnames, &maxnames);
+    /* files named on the command line are relative to where we started */
+    if (listfile) {
+        lf = strcmp(listfile, "-") ? fopen(listfile, "r") : stdin;
+        if (!lf) {
+            Fprintf(stderr, "%s: cannot open %s.\n", argv[0], listfile);
+            exit(EXIT_FAILURE);
         }
-        if (!*dir) {
-            Fprintf(stderr,
-                    "%s: flag -d must be followed by a directory name.\n",
-                    argv[0]);
+        while (fgets(buf, (int) sizeof buf, lf)) {
+            for (p = buf + strlen(buf);
+                 p > buf && (p[-1] == '\n' || p[-1] == '\r'); p--)
+                continue;
+            *p = '\0';
+            if (*buf)
+                add_name(buf, &names, &nnames, &maxnames);
+        }
+        if (lf != stdin)
+            (void) fclose(lf);
+    }
+    if (!nnames)
+        usage(argv[0], dir);
+    if (summary) {
+        if (!strcmp(summary, "-"))
+            sumfd = 1;
+        else if ((sumfd = open(summary, O_WRONLY | O_CREAT | O_TRUNC
+#ifdef O_APPEND
+                                                   | O_APPEND
+#endif
+                               , FCMASK)) < 0) {
+            Fprintf(stderr, "%s: cannot create %s.\n", argv[0], summary);
             exit(EXIT_FAILURE);
         }
-        argno++;
     }
 #if defined(SECURE) && !defined(VMS)
     if (dir
@@ -134,12 +237,13 @@ char *argv[];
         exit(EXIT_FAILURE);
     }
 
-    while (argc > argno) {
-        if (restore_savefile(argv[argno]) == 0)
-            Fprintf(stderr, "recovered \"%s\" to %s\n", argv[argno],
-                    savename);
-        argno++;
-    }
+#ifdef UNIX
+    if (jobs > 1 && nnames > 1)
+        recover_games(names, nnames, jobs, sumfd);
+    else
+#endif
+        for (i = 0; i < nnames; i++)
+            recover_game(names[i], sumfd);
 #ifdef AMIGA
     if (startdir)
         (void) chdir(startdir);
@@ -151,6 +255,11 @@ char *argv[];
 
 static char lock[256];
 
+/* for the summary line about the game restore_savefile() was given */
+static const char *why;      /* why it couldn't be recovered, or null */
+static int nlevels;          /* level files put into the save file */
+static unsigned long nbytes; /* size of the save file */
+
 void
 set_levelfile_name(lev)
 int lev;
@@ -194,21 +303,383 @@ create_savefile()
     return fd;
 }
 
-void
+#define COPYBUFSZ 65536
+
+/* write all of buf, however many write() calls that takes */
+static int
+write_all(fd, buf, len)
+int fd;
+const char *buf;
+unsigned long len;
+{
+    int n;
+
+    while (len > 0L) {
+        n = write(fd, buf, (unsigned) ((len > 1UL << 30) ? 1UL << 30 : len));
+        if (n <= 0)
+            return -1;
+        buf += n;
+        len -= (unsigned long) n;
+    }
+    return 0;
+}
+
+/* copy the rest of ifd to ofd; -1 if that couldn't be done */
+int
 copy_bytes(ifd, ofd)
 int ifd, ofd;
 {
-    char buf[BUFSIZ];
-    int nfrom, nto;
+    static char buf[COPYBUFSZ];
+    int nfrom;
+#ifdef MMAP_RESTORE
+    struct stat st;
+    off_t off;
+    char *p;
+    int res;
+
+    /* level files are copied with a single write from a mapping */
+    if (fstat(ifd, &st) == 0 && S_ISREG(st.st_mode)
+        && (off = lseek(ifd, (off_t) 0, 1)) >= 0) {
+        if (off >= st.st_size)
+            return 0;
+        p = (char *) mmap((genericptr_t) 0, (size_t) st.st_size, PROT_READ,
+                          MAP_PRIVATE, ifd, (off_t) 0);
+        if (p != (char *) MAP_FAILED) {
+            res = write_all(ofd, p + off, (unsigned long) (st.st_size - off));
+            (void) munmap((genericptr_t) p, (size_t) st.st_size);
+            (void) lseek(ifd, (off_t) st.st_size, 0);
+            return res;
+        }
+    }
+#endif
+    while ((nfrom = read(ifd, buf, COPYBUFSZ)) > 0)
+        if (write_all(ofd, buf, (unsigned long) nfrom) < 0)
+            return -1;
+    return nfrom < 0 ? -1 : 0;
+}
+
+/*
+ * The game may have kept a journal of what changed in level 0 and the
+ * current level since they were last written in full (see chkpt_delta()
+ * in files.c).  Apply every complete record in it to the level files,
+ * stopping at the first one that doesn't fit them.
+ */
+static struct jfile {
+    int lev; /* level file, or -1 */
+    char *buf;
+    unsigned long len;
+    int changed;
+} jfiles[2];
+
+static char *
+read_file(name, lenp)
+const char *name;
+unsigned long *lenp;
+{
+    int fd, n = 0;
+    unsigned long len = 0L, size = 0L;
+    char *buf = (char *) 0, *newbuf;
 
+#if defined(MICRO) || defined(WIN32) || defined(MSDOS)
+    fd = open(name, O_RDONLY | O_BINARY);
+#else
+    fd = open(name, O_RDONLY, 0);
+#endif
+    if (fd < 0)
+        return (char *) 0;
     do {
-        nfrom = read(ifd, buf, BUFSIZ);
-        nto = write(ofd, buf, nfrom);
-        if (nto != nfrom) {
-            Fprintf(stderr, "file copy failed!\n");
-            exit(EXIT_FAILURE);
+        if (len == size) {
+            size = size ? size * 2L : 65536L;
+            if (!(newbuf = (char *) realloc((genericptr_t) buf, size))) {
+                n = -1;
+                break;
+            }
+            buf = newbuf;
+        }
+        n = read(fd, buf + len, (unsigned) (size - len));
+        if (n > 0)
+            len += (unsigned long) n;
+    } while (n > 0);
+    Close(fd);
+    if (n < 0) {
+        if (buf)
+            free((genericptr_t) buf);
+        return (char *) 0;
+    }
+    *lenp = len;
+    return buf;
+}
+
+/* check, then apply, the parts of one record; returns its size, or 0 if
+   it's incomplete or doesn't fit */
+static unsigned long
+apply_record(rec, end, hpid)
+char *rec, *end;
+int hpid;
+{
+    struct chkpt_record hdr;
+    struct chkpt_part part;
+    struct chkpt_hunk hunk;
+    struct jfile *jf;
+    char *p, *q, *newbuf = (char *) 0;
+    unsigned long pos, outlen;
+    int pass, i, j, f;
+
+    if ((unsigned long) (end - rec) < sizeof hdr)
+        return 0L;
+    (void) memcpy((genericptr_t) &hdr, (genericptr_t) rec, sizeof hdr);
+    if (hdr.magic != CHKPT_MAGIC || hdr.pid != hpid
+        || hdr.size < sizeof hdr || hdr.size > (unsigned long) (end - rec))
+        return 0L;
+    end = rec + hdr.size;
+    /* the first pass only makes sure everything fits */
+    for (pass = 0; pass < 2; pass++) {
+        p = rec + sizeof hdr;
+        for (i = 0; i < hdr.nparts; i++) {
+            if ((unsigned long) (end - p) < sizeof part)
+                return 0L;
+            (void) memcpy((genericptr_t) &part, (genericptr_t) p,
+                          sizeof part);
+            p += sizeof part;
+            for (f = 0; f < 2; f++)
+                if (jfiles[f].lev == part.lev || jfiles[f].lev < 0)
+                    break;
+            if (f == 2 || part.lev < 0 || part.lev > 255)
+                return 0L;
+            jf = &jfiles[f];
+            if (jf->lev < 0) {
+                set_levelfile_name(part.lev);
+                if (!(jf->buf = read_file(lock, &jf->len)))
+                    return 0L;
+                jf->lev = part.lev;
+            }
+            if (jf->len != part.oldlen)
+                return 0L;
+            if (pass && !(newbuf = (char *) malloc(part.newlen + 1)))
+                return 0L;
+            pos = outlen = 0L;
+            for (j = 0; j < part.nhunks; j++) {
+                if ((unsigned long) (end - p) < sizeof hunk)
+                    return 0L;
+                (void) memcpy((genericptr_t) &hunk, (genericptr_t) p,
+                              sizeof hunk);
+                q = p + sizeof hunk;
+                if (hunk.off < pos || hunk.off > part.oldlen
+                    || hunk.oldcnt > part.oldlen - hunk.off
+                    || hunk.newcnt > (unsigned long) (end - q)
+                    || outlen + (hunk.off - pos) + hunk.newcnt > part.newlen)
+                    return 0L;
+                if (pass) {
+                    (void) memcpy((genericptr_t) (newbuf + outlen),
+                                  (genericptr_t) (jf->buf + pos),
+                                  hunk.off - pos);
+                    outlen += hunk.off - pos;
+                    (void) memcpy((genericptr_t) (newbuf + outlen),
+                                  (genericptr_t) q, hunk.newcnt);
+                    outlen += hunk.newcnt;
+                } else {
+                    outlen += hunk.off - pos + hunk.newcnt;
+                }
+                pos = hunk.off + hunk.oldcnt;
+                p = q + hunk.newcnt;
+            }
+            if (outlen + (part.oldlen - pos) != part.newlen)
+                return 0L;
+            if (pass) {
+                (void) memcpy((genericptr_t) (newbuf + outlen),
+                              (genericptr_t) (jf->buf + pos),
+                              part.oldlen - pos);
+                free((genericptr_t) jf->buf);
+                jf->buf = newbuf;
+                jf->len = part.newlen;
+                jf->changed = 1;
+            }
+        }
+    }
+    return hdr.size;
+}
+
+void
+apply_journal(basename)
+char *basename;
+{
+    char jname[256], tmpname[2][256 + 4], *journal, *rec;
+    unsigned long jlen, n;
+    int fd, f, hpid, ok = 1;
+
+    set_levelfile_name(0);
+    (void) strcpy(jname, lock);
+    (void) strcpy(rindex(jname, '.'), ".j");
+    if (!(journal = read_file(jname, &jlen)))
+        return; /* none, usually */
+    if ((fd = open_levelfile(0)) < 0
+        || read(fd, (genericptr_t) &hpid, sizeof hpid) != sizeof hpid) {
+        /* restore_savefile() will complain about this */
+        if (fd >= 0)
+            Close(fd);
+        free((genericptr_t) journal);
+        return;
+    }
+    Close(fd);
+
+    for (f = 0; f < 2; f++) {
+        jfiles[f].lev = -1;
+        jfiles[f].buf = (char *) 0;
+        jfiles[f].len = 0L;
+        jfiles[f].changed = 0;
+    }
+    for (rec = journal; rec < journal + jlen; rec += n)
+        if (!(n = apply_record(rec, journal + jlen, hpid)))
+            break;
+    if (rec < journal + jlen)
+        Fprintf(stderr, "Ignoring the last %lu bytes of %s.\n",
+                (unsigned long) (journal + jlen - rec), jname);
+    free((genericptr_t) journal);
+
+    /* write both files before replacing either, so that if one can't be
+       written, the ones from before the journal are still used */
+    for (f = 0; f < 2; f++) {
+        if (!jfiles[f].changed)
+            continue;
+        set_levelfile_name(jfiles[f].lev);
+        (void) sprintf(tmpname[f], "%s.new", lock);
+#if defined(MICRO) || defined(WIN32) || defined(MSDOS)
+        fd = open(tmpname[f], O_WRONLY | O_BINARY | O_CREAT | O_TRUNC,
+                  FCMASK);
+#else
+        fd = creat(tmpname[f], FCMASK);
+#endif
+        if (fd < 0 || write(fd, (genericptr_t) jfiles[f].buf,
+                            (unsigned) jfiles[f].len) != (int) jfiles[f].len)
+            ok = 0;
+        if (fd >= 0)
+            Close(fd);
+    }
+    for (f = 0; f < 2; f++) {
+        if (jfiles[f].changed) {
+            if (ok) {
+                set_levelfile_name(jfiles[f].lev);
+#if defined(MICRO) || defined(WIN32) || defined(MSDOS)
+                (void) unlink(lock);
+#endif
+                if (rename(tmpname[f], lock) < 0)
+                    ok = 0;
+            }
+            (void) unlink(tmpname[f]);
+        }
+        if (jfiles[f].buf)
+            free((genericptr_t) jfiles[f].buf);
+    }
+    if (ok)
+        (void) unlink(jname);
+    else
+        Fprintf(stderr, "Cannot apply %s; recovering without it.\n", jname);
+    (void) strcpy(lock, basename);
+}
+
+#define CRC_HDRSIZ 8
+
+/* CRC-32C of len bytes, a bit at a time since there are only a few */
+static unsigned long
+crc32c_bits(p, len)
+const unsigned char *p;
+unsigned len;
+{
+    unsigned long c = 0xffffffffUL;
+    int i;
+
+    while (len--)
+        for (c ^= *p++, i = 0; i < 8; i++)
+            c = (c & 1) ? (c >> 1) ^ 0x82f63b78UL : (c >> 1);
+    return ~c & 0xffffffffUL;
+}
+
+/* write the level number which goes in front of each level in the save
+   file as nethack's bwrite() would have, according to its save options:
+   in a chunk of its own for savecrc, zero-run encoded for zerocomp, and
+   in an uncompressed block for lzcomp */
+static int
+write_levc(fd, levc, sfi)
+int fd;
+xchar levc;
+struct savefile_info *sfi;
+{
+    unsigned char in[CRC_HDRSIZ + sizeof levc], out[2 * sizeof in + 4];
+    unsigned long crc;
+    unsigned n = 0, len = 0, i, run;
+
+    if (sfi->sfi1 & SFI1_CRC32C) {
+        crc = crc32c_bits((unsigned char *) &levc, sizeof levc);
+        for (i = 0; i < 4; i++) {
+            in[i] = (unsigned char) ((sizeof levc >> (8 * i)) & 0xff);
+            in[4 + i] = (unsigned char) ((crc >> (8 * i)) & 0xff);
+        }
+        n = CRC_HDRSIZ;
+    }
+    (void) memcpy((genericptr_t) &in[n], (genericptr_t) &levc, sizeof levc);
+    n += sizeof levc;
+    if (sfi->sfi1 & SFI1_LZCOMP) {
+        out[len++] = (unsigned char) n, out[len++] = 0;
+        out[len++] = 0, out[len++] = 0; /* stored as is */
+    }
+    if (sfi->sfi1 & SFI1_ZEROCOMP) {
+        for (i = 0; i < n; i++) {
+            out[len++] = in[i];
+            if (!in[i]) {
+                for (run = 0; i + 1 < n && !in[i + 1]; i++)
+                    run++;
+                out[len++] = (unsigned char) run;
+            }
+        }
+    } else {
+        (void) memcpy((genericptr_t) &out[len], (genericptr_t) in, n);
+        len += n;
+    }
+    return write_all(fd, (char *) out, (unsigned long) len);
+}
+
+/* check the start of each level file, before anything is written or
+   removed, so that files from another game don't end up in the save;
+   which[lev] is set for those which exist */
+static int
+check_levels(savelev, hpid, sfi, which)
+int savelev, hpid;
+struct savefile_info *sfi;
+char *which;
+{
+    int lev, fd, lpid;
+    xchar levc;
+    boolean raw, crc;
+    char hdr[CRC_HDRSIZ];
+
+    /* only zerocomp and lzcomp squeeze the pid and level number */
+    raw = !(sfi->sfi1 & (SFI1_ZEROCOMP | SFI1_LZCOMP));
+    crc = raw && (sfi->sfi1 & SFI1_CRC32C) != 0;
+    for (lev = 1; lev < 256; lev++) {
+        which[lev] = 0;
+        if ((fd = open_levelfile(lev)) < 0) {
+            if (lev != savelev)
+                continue; /* any or all of the others may not exist */
+            Fprintf(stderr, "Cannot open level of save for %s.\n", lock);
+            why = "nocurrentlevel";
+            return -1;
         }
-    } while (nfrom == BUFSIZ);
+        /* with savecrc, they follow the first chunk's header */
+        if ((crc && read(fd, (genericptr_t) hdr, sizeof hdr) != sizeof hdr)
+            || read(fd, (genericptr_t) &lpid, sizeof lpid) != sizeof lpid
+            || read(fd, (genericptr_t) &levc, sizeof levc) != sizeof levc
+            || (raw && (lpid != hpid || levc != (xchar) lev))) {
+            Fprintf(stderr,
+                    "%s is not from the same game -- can't recover.\n",
+                    lock);
+            Close(fd);
+            why = "badlevel";
+            return -1;
+        }
+        Close(fd);
+        which[lev] = 1;
+    }
+    return 0;
 }
 
 int
@@ -217,13 +688,17 @@ char *basename;
 {
     int gfd, lfd, sfd;
     int lev, savelev, hpid, pltmpsiz;
-    xchar levc;
     struct version_info version_data;
     struct savefile_info sfi;
-    char plbuf[PL_NSIZ];
+    char plbuf[PL_NSIZ], which[256];
+
+    why = (char *) 0;
+    nlevels = 0;
+    nbytes = 0L;
+    savename[0] = '\0';
 
     /* level 0 file contains:
-     *	pid of creating process (ignored here)
+     *	pid of creating process
      *	level number for current level of save file
      *	name of save file nethack would have created
      *	savefile info
@@ -231,6 +706,7 @@ char *basename;
      *	and game state
      */
     (void) strcpy(lock, basename);
+    apply_journal(basename);
     gfd = open_levelfile(0);
     if (gfd < 0) {
 #if defined(WIN32) && !defined(WIN_CE)
@@ -245,6 +721,7 @@ char *basename;
                     errno);
 #endif
         Fprintf(stderr, "Cannot open level 0 for %s.\n", basename);
+        why = "nolevel0";
         return -1;
     }
     if (read(gfd, (genericptr_t) &hpid, sizeof hpid) != sizeof hpid) {
@@ -253,6 +730,7 @@ char *basename;
             "Checkpoint data incompletely written or subsequently clobbered;",
             "recovery for \"", basename, "\" impossible.");
         Close(gfd);
+        why = "badlevel0";
         return -1;
     }
     if (read(gfd, (genericptr_t) &savelev, sizeof(savelev))
@@ -261,6 +739,7 @@ char *basename;
                         "impossible.\n",
                 basename);
         Close(gfd);
+        why = "nocheckpoint";
         return -1;
     }
     if ((read(gfd, (genericptr_t) savename, sizeof savename)
@@ -272,6 +751,19 @@ char *basename;
             != sizeof pltmpsiz) || (pltmpsiz > PL_NSIZ)
         || (read(gfd, (genericptr_t) &plbuf, pltmpsiz) != pltmpsiz)) {
         Fprintf(stderr, "Error reading %s -- can't recover.\n", lock);
+        Close(gfd);
+        savename[0] = '\0';
+        why = "badlevel0";
+        return -1;
+    }
+    savename[SAVESIZE - 1] = '\0';
+    if (savelev < 1 || savelev > 255) {
+        Fprintf(stderr, "Error reading %s -- can't recover.\n", lock);
+        Close(gfd);
+        why = "badlevel0";
+        return -1;
+    }
+    if (check_levels(savelev, hpid, &sfi, which) < 0) {
         Close(gfd);
         return -1;
     }
@@ -288,6 +780,7 @@ char *basename;
     if (sfd < 0) {
         Fprintf(stderr, "Cannot create savefile %s.\n", savename);
         Close(gfd);
+        why = "nosavefile";
         return -1;
     }
 
@@ -296,75 +789,56 @@ char *basename;
         Fprintf(stderr, "Cannot open level of save for %s.\n", basename);
         Close(gfd);
         Close(sfd);
+        (void) unlink(savename);
+        why = "nocurrentlevel";
         return -1;
     }
 
     if (write(sfd, (genericptr_t) &version_data, sizeof version_data)
-        != sizeof version_data) {
-        Fprintf(stderr, "Error writing %s; recovery failed.\n", savename);
-        Close(gfd);
-        Close(sfd);
-        Close(lfd);
-        return -1;
-    }
-
-    if (write(sfd, (genericptr_t) &sfi, sizeof sfi) != sizeof sfi) {
-        Fprintf(stderr,
-                "Error writing %s; recovery failed (savefile_info).\n",
-                savename);
-        Close(gfd);
-        Close(sfd);
-        Close(lfd);
-        return -1;
-    }
-
-    if (write(sfd, (genericptr_t) &pltmpsiz, sizeof pltmpsiz)
-        != sizeof pltmpsiz) {
-        Fprintf(stderr,
-                "Error writing %s; recovery failed (player name size).\n",
-                savename);
+            != sizeof version_data
+        || write(sfd, (genericptr_t) &sfi, sizeof sfi) != sizeof sfi
+        || write(sfd, (genericptr_t) &pltmpsiz, sizeof pltmpsiz)
+               != sizeof pltmpsiz
+        || write(sfd, (genericptr_t) &plbuf, pltmpsiz) != pltmpsiz
+        || copy_bytes(lfd, sfd) < 0 || copy_bytes(gfd, sfd) < 0) {
         Close(gfd);
-        Close(sfd);
         Close(lfd);
-        return -1;
+        goto writefailed;
     }
-
-    if (write(sfd, (genericptr_t) &plbuf, pltmpsiz) != pltmpsiz) {
-        Fprintf(stderr, "Error writing %s; recovery failed (player name).\n",
-                savename);
-        Close(gfd);
-        Close(sfd);
-        Close(lfd);
-        return -1;
-    }
-
-    copy_bytes(lfd, sfd);
     Close(lfd);
-    (void) unlink(lock);
-
-    copy_bytes(gfd, sfd);
     Close(gfd);
-    set_levelfile_name(0);
-    (void) unlink(lock);
+    nlevels = 2;
 
     for (lev = 1; lev < 256; lev++) {
         /* level numbers are kept in xchars in save.c, so the
          * maximum level number (for the endlevel) must be < 256
          */
-        if (lev != savelev) {
+        if (which[lev] && lev != savelev) {
             lfd = open_levelfile(lev);
-            if (lfd >= 0) {
-                /* any or all of these may not exist */
-                levc = (xchar) lev;
-                write(sfd, (genericptr_t) &levc, sizeof(levc));
-                copy_bytes(lfd, sfd);
-                Close(lfd);
-                (void) unlink(lock);
+            if (lfd < 0 || write_levc(sfd, (xchar) lev, &sfi) < 0
+                || copy_bytes(lfd, sfd) < 0) {
+                if (lfd >= 0)
+                    Close(lfd);
+                goto writefailed;
             }
+            Close(lfd);
+            nlevels++;
         }
     }
+    nbytes = (unsigned long) lseek(sfd, (off_t) 0, 1);
+    if (close(sfd) < 0) {
+        sfd = -1;
+        goto writefailed;
+    }
 
-    Close(sfd);
+    /* the level files can go, now that the save file is complete */
+    for (lev = 1; lev < 256; lev++)
+        if (which[lev]) {
+            set_levelfile_name(lev);
+            (void) unlink(lock);
+        }
+    set_levelfile_name(0);
+    (void) unlink(lock);
 
 #if 0 /* OBSOLETE, HackWB is no longer in use */
 #ifdef AMIGA
@@ -389,8 +863,70 @@ char *basename;
 #endif /*AMIGA*/
 #endif
     return 0;
+
+writefailed:
+    Fprintf(stderr, "Error writing %s; recovery failed.\n", savename);
+    if (sfd >= 0)
+        Close(sfd);
+    (void) unlink(savename);
+    why = "writefailed";
+    nlevels = 0;
+    nbytes = 0L;
+    return -1;
+}
+
+/* recover one game and add a line about it to the summary:  the base name,
+   "ok" or why it couldn't be recovered, the save file, how many levels went
+   into it, and its size, separated by tabs */
+void
+recover_game(basename, sumfd)
+char *basename;
+int sumfd;
+{
+    char line[BUFSIZ];
+    int len;
+
+    if (restore_savefile(basename) == 0)
+        Fprintf(stderr, "recovered \"%s\" to %s\n", basename, savename);
+    if (sumfd < 0)
+        return;
+    (void) sprintf(line, "%.*s\t%s\t%.*s\t%d\t%lu\n", (int) sizeof lock - 1,
+                   basename, why ? why : "ok", SAVESIZE,
+                   savename[0] ? savename : "-", nlevels, nbytes);
+    len = (int) strlen(line);
+    /* one write per line, so lines from several workers don't mix */
+    if (write(sumfd, line, len) != len)
+        Fprintf(stderr, "Error writing summary for %s.\n", basename);
 }
 
+#ifdef UNIX
+/* divide the games among 'jobs' worker processes */
+void
+recover_games(names, nnames, jobs, sumfd)
+char **names;
+int nnames, jobs, sumfd;
+{
+    int k, i;
+    pid_t pid;
+
+    if (jobs > nnames)
+        jobs = nnames;
+    for (k = 0; k < jobs; k++) {
+        if ((pid = fork()) == 0) {
+            for (i = k; i < nnames; i += jobs)
+                recover_game(names[i], sumfd);
+            exit(EXIT_SUCCESS);
+        } else if (pid < 0) {
+            /* no worker for this share; do it here */
+            for (i = k; i < nnames; i += jobs)
+                recover_game(names[i], sumfd);
+        }
+    }
+    while (wait((int *) 0) > 0)
+        continue;
+}
+#endif
+
 #ifdef EXEPATH
 #ifdef __DJGPP__
 #define PATH_SEPARATOR '/'